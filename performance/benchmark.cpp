@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <Column.h>
+#include <Context.h>
+#include <Eval.h>
+#include <FS.h>
+#include <JSON.h>
+#include <Lexer.h>
+#include <Profiler.h>
+#include <Task.h>
+#include <ViewTask.h>
+#include <format.h>
+#include <main.h>
+
+// Micro-benchmarks of the hot paths, over synthetic data sets.
+//
+// Usage: benchmark [<tasks> ...]
+//
+// Each benchmark is run over all tasks of a data set, repeatedly until it has
+// run for at least MINIMUM_NS, and reports the time and allocations per task.
+
+static const long long MINIMUM_NS = 200000000;
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs fn, which performs one operation per task, and reports the cost.
+template <typename F>
+static void measure (const std::string& name, size_t tasks, F fn)
+{
+  auto allocations = Profiler::allocations ();
+  auto start = std::chrono::steady_clock::now ();
+
+  long long elapsed = 0;
+  long runs = 0;
+  do
+  {
+    fn ();
+    ++runs;
+    elapsed = std::chrono::duration_cast <std::chrono::nanoseconds> (std::chrono::steady_clock::now () - start).count ();
+  }
+  while (elapsed < MINIMUM_NS);
+
+  double ops = (double) runs * (double) tasks;
+  std::cout << std::left  << std::setw (34) << name
+            << std::right << std::setw (10) << tasks
+            << std::setw (14) << std::fixed << std::setprecision (1) << elapsed / ops
+            << std::setw (14) << std::fixed << std::setprecision (2) << (Profiler::allocations () - allocations) / ops
+            << '\n';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A deterministic mix of pending and completed tasks, with the attributes a
+// typical task list has.
+static std::vector <Task> generate (size_t count)
+{
+  static const char* projects[]   = {"Home", "Work", "Garden.Care", "Work.Reports", ""};
+  static const char* priorities[] = {"H", "M", "L", ""};
+  static const char* tags[]       = {"next", "phone", "errand", "waiting", "someday"};
+
+  std::vector <Task> tasks;
+  tasks.reserve (count);
+
+  time_t now = time (nullptr);
+  for (size_t i = 0; i < count; ++i)
+  {
+    Task task;
+    task.set ("uuid", format ("{1}-0000-4000-8000-{2}",
+                              format ("{1}", 10000000 + i % 90000000),
+                              format ("{1}", 100000000000 + i)));
+    task.set ("description", format ("Task {1} with an average sized description", i));
+    task.set ("entry", (long) (now - 86400 * (long) (i % 400)));
+
+    if (i % 5)
+      task.set ("status", "pending");
+    else
+    {
+      task.set ("status", "completed");
+      task.set ("end", (long) (now - 3600 * (long) (i % 400)));
+    }
+
+    if (*projects[i % 5])
+      task.set ("project", projects[i % 5]);
+
+    if (*priorities[i % 4])
+      task.set ("priority", priorities[i % 4]);
+
+    if (i % 3 == 0)
+      task.set ("due", (long) (now + 86400 * (long) (i % 30) - 86400 * 10));
+
+    if (i % 2)
+      task.addTag (tags[i % 5]);
+
+    if (i % 10 == 0)
+      task.set (format ("annotation_{1}", (long) now - (long) i), "An annotation on this task");
+
+    task.id = task.getStatus () == Task::pending ? (int) i + 1 : 0;
+    tasks.push_back (task);
+  }
+
+  return tasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void benchmark (size_t count)
+{
+  auto tasks = generate (count);
+
+  std::vector <std::string> f4;
+  std::vector <std::string> json;
+  for (auto& task : tasks)
+  {
+    f4.push_back (task.composeF4 ());
+    json.push_back (task.composeJSON ());
+  }
+
+  measure ("Task::parse", count, [&] ()
+  {
+    for (auto& line : f4)
+    {
+      Task task;
+      task.parse (line);
+    }
+  });
+
+  measure ("Task::composeF4", count, [&] ()
+  {
+    for (auto& task : tasks)
+      task.composeF4 ();
+  });
+
+  measure ("Task::composeJSON", count, [&] ()
+  {
+    for (auto& task : tasks)
+      task.composeJSON ();
+  });
+
+  measure ("json::parse", count, [&] ()
+  {
+    for (auto& line : json)
+      delete json::parse (line);
+  });
+
+  measure ("Task::urgency_c", count, [&] ()
+  {
+    for (auto& task : tasks)
+      task.urgency_c ();
+  });
+
+  // The compiled form of 'project:Home priority:H +next'.
+  Eval eval;
+  eval.bindDOM (true);
+  eval.compileExpression ({
+    {"project",  Lexer::Type::dom},
+    {"=",        Lexer::Type::op},
+    {"Home",     Lexer::Type::string},
+    {"and",      Lexer::Type::op},
+    {"priority", Lexer::Type::dom},
+    {"=",        Lexer::Type::op},
+    {"H",        Lexer::Type::string},
+    {"and",      Lexer::Type::op},
+    {"tags",     Lexer::Type::dom},
+    {"_hastag_", Lexer::Type::op},
+    {"next",     Lexer::Type::string}});
+
+  measure ("Eval::evaluateCompiledExpression", count, [&] ()
+  {
+    Variant result;
+    for (auto& task : tasks)
+      eval.evaluateCompiledExpression (task, result);
+  });
+
+  std::vector <int> order (count);
+  measure ("sort_tasks", count, [&] ()
+  {
+    for (size_t i = 0; i < count; ++i)
+      order[i] = (int) i;
+
+    sort_tasks (tasks, order, "project+,due+,description+");
+  });
+
+  std::string report = "benchmark";
+  ViewTask view;
+  view.add (Column::factory ("id", report));
+  view.add (Column::factory ("project", report));
+  view.add (Column::factory ("priority", report));
+  view.add (Column::factory ("tags", report));
+  view.add (Column::factory ("due.relative", report));
+  view.add (Column::factory ("description.count", report));
+  view.add (Column::factory ("urgency", report));
+  view.width (120);
+
+  measure ("ViewTask::render", count, [&] ()
+  {
+    view.render (tasks, order);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int main (int argc, char** argv)
+{
+  Profiler::count_allocations (true);
+
+  std::vector <size_t> sizes;
+  for (int i = 1; i < argc; ++i)
+    sizes.push_back (strtoul (argv[i], nullptr, 10));
+
+  if (sizes.size () == 0)
+    sizes = {1000, 10000, 100000, 1000000};
+
+  // A throwaway configuration and data location, so that the environment has
+  // no influence.
+  char directory[] = "/tmp/task_benchmark_XXXXXX";
+  if (! mkdtemp (directory))
+  {
+    std::cerr << "Could not create a temporary directory.\n";
+    return 1;
+  }
+
+  std::string rc = std::string (directory) + "/benchmark.rc";
+  File::write (rc, "verbose=nothing\nhooks=0\ncolor=0\n");
+  setenv ("TASKRC", rc.c_str (), 1);
+  setenv ("TASKDATA", directory, 1);
+
+  Context context;
+  Context::setContext (&context);
+
+  int status = 0;
+  try
+  {
+    const char* args[] = {"task", "list"};
+    status = context.initialize (2, args);
+
+    if (status == 0)
+    {
+      std::cout << std::left  << std::setw (34) << "benchmark"
+                << std::right << std::setw (10) << "tasks"
+                << std::setw (14) << "ns/op"
+                << std::setw (14) << "allocs/op"
+                << '\n';
+
+      for (auto size : sizes)
+        benchmark (size);
+    }
+  }
+
+  catch (const std::string& error)
+  {
+    std::cerr << error << '\n';
+    status = 1;
+  }
+
+  unlink (rc.c_str ());
+  rmdir (directory);
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
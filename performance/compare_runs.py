@@ -4,23 +4,27 @@
 #
 # Run without arguments for usage information.
 #
-# "Perf task" lines in debug output differing between the two versions is
-# poorly handled, if at all.  Best used for comparing performance between two
-# similar Taskwarrior versions only differing in performance related code.
+# Each benchmark in the run_perf output is followed by the JSON profile that
+# rc.profile writes.  The best (minimum) value of each phase and counter over
+# all runs is compared, so phases or counters only present in one version show
+# up as a change from zero.  Output from versions without rc.profile, which
+# have a "Perf task" debug line instead, is also read, though it has no
+# counters.
 #
-# "total" will probably not be the sum of the shown individual parts, but
+# "total" will probably not be the sum of the shown individual phases, but
 # slightly larger since not all minimum values will have been present in the
 # same run.
 #
 
 import collections
+import json
 import re
 import sys
 
 # Adjust if more performance tests are added
 COMMANDS = "next list all add export import".split()
 
-TaskPerf = collections.namedtuple("TaskPerf", "version commit at timing")
+TaskPerf = collections.namedtuple("TaskPerf", "version commit at timing counters")
 
 
 def parse_perf(input):
@@ -29,24 +33,66 @@ def parse_perf(input):
         tests[command] = []
 
         # Parse concatenated run_perf output
-        for i in re.findall("^  - task %s\.\.\.\n"
-                            "Perf task ([^ ]+) ([^ ]+) ([^ ]+) (.+)$"
+        for line in re.findall(r"^  - task %s\.\.\.\n(\{.*\})$" % command,
+                               input, re.MULTILINE):
+            run = json.loads(line)
+            profile = run["profile"]
+
+            # The root phase holds the time not attributed to any other.
+            timing = dict(profile["phases"])
+            timing["other"] = timing.pop("total", 0)
+            timing["total"] = profile["total_us"]
+
+            counters = dict(profile["counters"])
+            counters["allocations"] = profile["allocations"]
+
+            tests[command].append(TaskPerf(run["version"], run["commit"],
+                                           run["date"], timing, counters))
+
+        # Older versions, with "Perf task" lines
+        for i in re.findall(r"^  - task %s\.\.\.\n"
+                            r"Perf task ([^ ]+) ([^ ]+) ([^ ]+) (.+)$"
                             % command, input, re.MULTILINE):
-            info = i[0:3] + ({k:v for k, v in (i.split(":") for i in i[-1].split())},)
-            pt = TaskPerf(*info)
-            tests[command].append(pt)
+            timing = dict(k.split(":") for k in i[-1].split())
+            tests[command].append(TaskPerf(i[0], i[1], i[2], timing, {}))
     return tests
 
 
-def get_best(tests):
+def get_best(tests, field):
     best = {}
     for command in tests:
         best[command] = {}
-        for k in tests[command][0].timing:
-            best[command][k] = str(min(int(t.timing[k]) for t in tests[command]))
+        keys = set()
+        for t in tests[command]:
+            keys.update(getattr(t, field).keys())
+        for k in keys:
+            best[command][k] = str(min(int(getattr(t, field).get(k, 0))
+                                       for t in tests[command]))
     return best
 
 
+def compare(prev, cur):
+    out = ["" for i in range(5)]
+    for k in sorted(set(prev.keys()) | set(cur.keys())):
+        p = prev.get(k, "0")
+        c = cur.get(k, "0")
+        diff = str(int(c) - int(p))
+
+        if float(p) > 0:
+            percentage = str(int((float(diff) / float(p) * 100))) + "%"
+        else:
+            percentage = "0%"
+
+        pad = max(map(len, (k, p, c, diff, percentage)))
+        out[0] += " %s" % k.rjust(pad)
+        out[1] += " %s" % p.rjust(pad)
+        out[2] += " %s" % c.rjust(pad)
+        out[3] += " %s" % diff.rjust(pad)
+        out[4] += " %s" % percentage.rjust(pad)
+    for line in out:
+        print(line)
+
+
 if len(sys.argv) != 3:
     print("Usage:")
     print(" $ %s file1 file2" % sys.argv[0])
@@ -56,31 +102,19 @@ if len(sys.argv) != 3:
 
 with open(sys.argv[1], "r") as fh:
     tests_prev = parse_perf(fh.read())
-    best_prev = get_best(tests_prev)
 with open(sys.argv[2], "r") as fh:
     tests_cur = parse_perf(fh.read())
-    best_cur = get_best(tests_cur)
+
+timing_prev = get_best(tests_prev, "timing")
+timing_cur = get_best(tests_cur, "timing")
+counters_prev = get_best(tests_prev, "counters")
+counters_cur = get_best(tests_cur, "counters")
 
 print("Previous: %s (%s)" % (tests_prev[COMMANDS[0]][0].version, tests_prev[COMMANDS[0]][0].commit))
 print("Current:  %s (%s)" % (tests_cur[COMMANDS[0]][0].version, tests_cur[COMMANDS[0]][0].commit))
 
 for test in COMMANDS:
     print("# %s:" % test)
-
-    out = ["" for i in range(5)]
-    for k in sorted(best_prev[test].keys()):
-        diff = str(int(best_cur[test][k]) - int(best_prev[test][k]))
-
-        if float(best_prev[test][k]) > 0:
-            percentage = str(int((float(diff) / float(best_prev[test][k]) * 100))) + "%"
-        else:
-            percentage = "0%"
-
-        pad = max(map(len, (k, best_prev[test][k], best_cur[test][k], diff, percentage)))
-        out[0] += " %s" % k.rjust(pad)
-        out[1] += " %s" % best_prev[test][k].rjust(pad)
-        out[2] += " %s" % best_cur[test][k].rjust(pad)
-        out[3] += " %s" % diff.rjust(pad)
-        out[4] += " %s" % percentage.rjust(pad)
-    for line in out:
-        print(line)
+    compare(timing_prev[test], timing_cur[test])
+    print("# %s counters:" % test)
+    compare(counters_prev[test], counters_cur[test])
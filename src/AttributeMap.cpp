@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <AttributeMap.h>
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the one shared copy of a name.  The core attribute names are
+// interned up front, in a set that is only read, so that tasks are parsed
+// concurrently without contention.  Other names, UDAs and annotations, are
+// interned under a lock as they are first seen.  Interned names are never
+// released, and the set only grows by the attribute names in use.
+const std::string* AttributeMap::intern (const std::string& name)
+{
+  static const std::unordered_set <std::string> core {
+    "depends", "description", "due", "end", "entry", "imask", "last", "mask",
+    "modified", "parent", "priority", "project", "recur", "rtype", "scheduled",
+    "start", "status", "tags", "template", "until", "uuid", "wait"};
+
+  auto known = core.find (name);
+  if (known != core.end ())
+    return &*known;
+
+  static std::unordered_set <std::string> names;
+  static std::mutex lock;
+
+  std::lock_guard <std::mutex> guard (lock);
+  return &*names.insert (name).first;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::vector <AttributeMap::Entry>::const_iterator AttributeMap::position (const std::string& name) const
+{
+  return std::lower_bound (_entries.begin (), _entries.end (), name,
+                           [] (const Entry& entry, const std::string& key)
+                           {
+                             return *entry.first < key;
+                           });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+AttributeMap::const_iterator AttributeMap::find (const std::string& name) const
+{
+  auto i = position (name);
+  if (i != _entries.end () && *i->first == name)
+    return const_iterator (i);
+
+  return end ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+AttributeMap::iterator AttributeMap::find (const std::string& name)
+{
+  ++_version;
+  auto i = position (name);
+  if (i != _entries.end () && *i->first == name)
+    return iterator (_entries.begin () + (i - _entries.cbegin ()));
+
+  return end ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string& AttributeMap::operator[] (const std::string& name)
+{
+  ++_version;
+  auto i = position (name);
+  if (i != _entries.end () && *i->first == name)
+    return _entries[i - _entries.cbegin ()].second;
+
+  return _entries.insert (i, Entry {intern (name), ""})->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// As std::map::insert, an existing attribute is left unchanged.
+bool AttributeMap::insert (const std::pair <const std::string, std::string>& attribute)
+{
+  auto i = position (attribute.first);
+  if (i != _entries.end () && *i->first == attribute.first)
+    return false;
+
+  ++_version;
+  _entries.insert (i, Entry {intern (attribute.first), attribute.second});
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+size_t AttributeMap::erase (const std::string& name)
+{
+  auto i = position (name);
+  if (i != _entries.end () && *i->first == name)
+  {
+    ++_version;
+    _entries.erase (i);
+    return 1;
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unlike std::map, this invalidates other iterators, so use the result.
+AttributeMap::iterator AttributeMap::erase (iterator i)
+{
+  ++_version;
+  return iterator (_entries.erase (i._base));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Names are interned, so they compare by address.
+bool AttributeMap::operator== (const AttributeMap& other) const
+{
+  if (_entries.size () != other._entries.size ())
+    return false;
+
+  for (size_t i = 0; i < _entries.size (); ++i)
+    if (_entries[i].first  != other._entries[i].first ||
+        _entries[i].second != other._entries[i].second)
+      return false;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_ATTRIBUTEMAP
+#define INCLUDED_ATTRIBUTEMAP
+
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// AttributeMap holds the attributes of a task, in a flat vector sorted by
+// name.  Names are interned, so that every task shares one copy of each, and
+// an attribute costs one pointer plus its value.  It supports the subset of
+// the std::map interface that Task uses, and iterates in the same order.
+// Lookups are a binary search by name, not a fixed slot per attribute, as
+// tasks hold few attributes, and the name order is the order F4 and JSON use.
+//
+// The version changes with every access that could modify the map, so that
+// values derived from it can be cached, and checked for staleness.
+class AttributeMap
+{
+  using Entry = std::pair <const std::string*, std::string>;
+
+public:
+  // Iterators yield a pair of references by value, so that 'first' and
+  // 'second' work as they do for a std::map.  Bind it with 'const auto&' or
+  // 'auto', as there is no pair in the map for 'auto&' to refer to.
+  template <bool Const>
+  class Iterator
+  {
+    using Base  = typename std::conditional <Const, std::vector <Entry>::const_iterator, std::vector <Entry>::iterator>::type;
+    using Value = typename std::conditional <Const, const std::string, std::string>::type;
+
+  public:
+    struct Pair
+    {
+      const std::string& first;
+      Value&             second;
+    };
+
+    struct Arrow
+    {
+      Pair pair;
+      const Pair* operator-> () const { return &pair; }
+    };
+
+    using iterator_category = std::input_iterator_tag;
+    using value_type        = Pair;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = Arrow;
+    using reference         = Pair;
+
+    Iterator () = default;
+    Iterator (Base base) : _base (base) {}
+    template <bool C = Const, typename = typename std::enable_if <C>::type>
+    Iterator (const Iterator <false>& other) : _base (other._base) {}
+
+    Pair operator* () const   { return Pair {*_base->first, _base->second}; }
+    Arrow operator-> () const { return Arrow {**this}; }
+    Iterator& operator++ ()   { ++_base; return *this; }
+    Iterator operator++ (int) { auto copy = *this; ++_base; return copy; }
+    bool operator== (const Iterator& other) const { return _base == other._base; }
+    bool operator!= (const Iterator& other) const { return _base != other._base; }
+
+  private:
+    friend class AttributeMap;
+    friend class Iterator <true>;
+
+    Base _base {};
+  };
+
+  using iterator       = Iterator <false>;
+  using const_iterator = Iterator <true>;
+
+  iterator       begin ()       { ++_version; return iterator (_entries.begin ()); }
+  iterator       end ()         { return iterator (_entries.end ()); }
+  const_iterator begin () const { return const_iterator (_entries.begin ()); }
+  const_iterator end () const   { return const_iterator (_entries.end ()); }
+
+  size_t size () const { return _entries.size (); }
+  bool empty () const  { return _entries.empty (); }
+  void clear ()        { ++_version; _entries.clear (); }
+  unsigned long version () const { return _version; }
+
+  iterator find (const std::string&);
+  const_iterator find (const std::string&) const;
+  std::string& operator[] (const std::string&);
+  bool insert (const std::pair <const std::string, std::string>&);
+  size_t erase (const std::string&);
+  iterator erase (iterator);
+
+  bool operator== (const AttributeMap&) const;
+  bool operator!= (const AttributeMap& other) const { return ! (*this == other); }
+
+  static const std::string* intern (const std::string&);
+
+private:
+  std::vector <Entry>::const_iterator position (const std::string&) const;
+
+private:
+  std::vector <Entry> _entries {};
+  unsigned long       _version {0};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -40,6 +40,7 @@
 #include <Variant.h>
 #include <Datetime.h>
 #include <Duration.h>
+#include <JSON.h>
 #include <shared.h>
 #include <format.h>
 #include <main.h>
@@ -72,6 +73,9 @@ std::string configurationDefaults =
   "# Files\n"
   "data.location=~/.task\n"
   "locking=1                                      # Use file-level locking\n"
+  "snapshot=1                                     # Cache parsed data files in binary snapshots\n"
+  "index=1                                        # Index completed.data for partial loading\n"
+  "data.journal=0                                 # Journal changes instead of rewriting data files\n"
   "gc=1                                           # Garbage-collect data files - DO NOT CHANGE unless you are sure\n"
   "exit.on.missing.db=0                           # Whether to exit if ~/.task is not found\n"
   "hooks=1                                        # Master control switch for hooks\n"
@@ -92,11 +96,14 @@ std::string configurationDefaults =
   "recurrence=1                                   # Enable recurrence\n"
   "recurrence.confirmation=prompt                 # Confirmation for propagating changes among recurring tasks (yes/no/prompt)\n"
   "allow.empty.filter=1                           # An empty filter gets a warning and requires confirmation\n"
+  "filter.threads=0                               # Threads used to filter large task lists, 0 for one per core\n"
   "indent.annotation=2                            # Indent spaces for annotations\n"
   "indent.report=0                                # Indent spaces for whole report\n"
   "row.padding=0                                  # Left and right padding for each row of report\n"
   "column.padding=1                               # Spaces between each column in a report\n"
+  "stream.sample=0                                # Rows measured when streaming a report to a pipe, 0 to disable\n"
   "bulk=3                                         # 3 or more tasks considered a bulk change and is confirmed\n"
+  "batch.commit=0                                 # Commands between commits in a batch, 0 for once at the end\n"
   "nag=You have more urgent tasks.                # Nag message to keep you honest\n"                      // TODO
   "search.case.sensitive=1                        # Setting to no allows case insensitive searches\n"
   "active.indicator=*                             # What to show as an active task indicator\n"
@@ -265,6 +272,7 @@ std::string configurationDefaults =
   "print.empty.columns=0                          # Print columns which have no data for any task\n"
   "debug=0                                        # Display diagnostics\n"
   "debug.tls=0                                    # Sync diagnostics\n"
+  "profile=                                       # Profile output as JSON, to a file or 'stderr'\n"
   "sugar=1                                        # Syntactic sugar\n"
   "obfuscate=0                                    # Obfuscate data for error reporting\n"
   "fontunderline=1                                # Uses underlines rather than -------\n"
@@ -436,112 +444,138 @@ Context::~Context ()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-int Context::initialize (int argc, const char** argv)
+// Startup that does not depend on the command, other than rc overrides.
+void Context::configure (int argc, const char** argv)
 {
-  timer_total.start ();
-  int rc = 0;
-
-  try
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  // [1] Load the correct config file.
+  //     - Default to ~/.taskrc (ctor).
+  //     - Allow $TASKRC override.
+  //     - Allow command line override rc:<file>
+  //     - Load resultant file.
+  //     - Apply command line overrides to the config.
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  bool taskrc_overridden = CLI2::getOverride (argc, argv, home_dir, rc_file);
+  if (! taskrc_overridden)
   {
-    ////////////////////////////////////////////////////////////////////////////
-    //
-    // [1] Load the correct config file.
-    //     - Default to ~/.taskrc (ctor).
-    //     - Allow $TASKRC override.
-    //     - Allow command line override rc:<file>
-    //     - Load resultant file.
-    //     - Apply command line overrides to the config.
-    //
-    ////////////////////////////////////////////////////////////////////////////
-
-    bool taskrc_overridden = CLI2::getOverride (argc, argv, home_dir, rc_file);
-    if (! taskrc_overridden)
+    char *override = getenv ("TASKRC");
+    if (override)
     {
-      char *override = getenv ("TASKRC");
-      if (override)
-      {
-        rc_file = File (override);
-        taskrc_overridden = true;
-      }
+      rc_file = File (override);
+      taskrc_overridden = true;
     }
+  }
 
-    // Artificial scope for timing purposes.
+  // Artificial scope for timing purposes.
+  {
+    Timer timer;
+    config.parse (configurationDefaults);
+    config.load (rc_file._data);
+    debugTiming (format ("Config::load ({1})", rc_file._data), timer);
+  }
+
+  CLI2::applyOverrides (argc, argv);
+  Profiler::count_allocations (config.get ("profile") != "");
+
+  if (taskrc_overridden && verbose ("override"))
+    header (format ("TASKRC override: {1}", rc_file._data));
+
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  // [2] Locate the data directory.
+  //     - Default to ~/.task (ctor).
+  //     - Allow $TASKDATA override.
+  //     - Allow command line override rc.data.location:<dir>
+  //     - Inform TDB2 where to find data.
+  //     - Create the rc_file and data_dir, if necessary.
+  //
+  ////////////////////////////////////////////////////////////////////////////
+
+  bool taskdata_overridden = CLI2::getDataLocation (argc, argv, data_dir);
+  if (! taskdata_overridden)
+  {
+    char *override = getenv("TASKDATA");
+    if (override)
     {
-      Timer timer;
-      config.parse (configurationDefaults);
-      config.load (rc_file._data);
-      debugTiming (format ("Config::load ({1})", rc_file._data), timer);
+      data_dir = Directory (override);
+      config.set ("data.location", data_dir._data);
+      taskdata_overridden = true;
     }
+  }
+  if (taskdata_overridden && verbose ("override"))
+    header (format ("TASKDATA override: {1}", data_dir._data));
 
-    CLI2::applyOverrides (argc, argv);
+  tdb2.set_location (data_dir);
+  createDefaultConfig ();
 
-    if (taskrc_overridden && verbose ("override"))
-      header (format ("TASKRC override: {1}", rc_file._data));
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  // [3] Instantiate Command objects and capture command entities.
+  //
+  ////////////////////////////////////////////////////////////////////////////
 
-    ////////////////////////////////////////////////////////////////////////////
-    //
-    // [2] Locate the data directory.
-    //     - Default to ~/.task (ctor).
-    //     - Allow $TASKDATA override.
-    //     - Allow command line override rc.data.location:<dir>
-    //     - Inform TDB2 where to find data.
-    //     - Create the rc_file and data_dir, if necessary.
-    //
-    ////////////////////////////////////////////////////////////////////////////
+  Command::factory (commands);
+  for (auto& cmd : commands)
+    cli2.entity ("cmd", cmd.first);
 
-    bool taskdata_overridden = CLI2::getDataLocation (argc, argv, data_dir);
-    if (! taskdata_overridden)
-    {
-      char *override = getenv("TASKDATA");
-      if (override)
-      {
-        data_dir = Directory (override);
-        config.set ("data.location", data_dir._data);
-        taskdata_overridden = true;
-      }
-    }
-    if (taskdata_overridden && verbose ("override"))
-      header (format ("TASKDATA override: {1}", data_dir._data));
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  // [4] Instantiate Column objects and capture column entities.
+  //
+  ////////////////////////////////////////////////////////////////////////////
 
-    tdb2.set_location (data_dir);
-    createDefaultConfig ();
+  Column::factory (columns);
+  for (auto& col : columns)
+    cli2.entity ("attribute", col.first);
 
-    ////////////////////////////////////////////////////////////////////////////
-    //
-    // [3] Instantiate Command objects and capture command entities.
-    //
-    ////////////////////////////////////////////////////////////////////////////
+  cli2.entity ("pseudo", "limit");
 
-    Command::factory (commands);
-    for (auto& cmd : commands)
-      cli2.entity ("cmd", cmd.first);
+  ////////////////////////////////////////////////////////////////////////////
+  //
+  // [5] Capture modifier and operator entities.
+  //
+  ////////////////////////////////////////////////////////////////////////////
 
-    ////////////////////////////////////////////////////////////////////////////
-    //
-    // [4] Instantiate Column objects and capture column entities.
-    //
-    ////////////////////////////////////////////////////////////////////////////
+  for (unsigned int i = 0; i < NUM_MODIFIER_NAMES; ++i)
+    cli2.entity ("modifier", modifierNames[i]);
 
-    Column::factory (columns);
-    for (auto& col : columns)
-      cli2.entity ("attribute", col.first);
+  for (auto& op : Eval::getOperators ())
+    cli2.entity ("operator", op);
 
-    cli2.entity ("pseudo", "limit");
-
-    ////////////////////////////////////////////////////////////////////////////
-    //
-    // [5] Capture modifier and operator entities.
-    //
-    ////////////////////////////////////////////////////////////////////////////
+  for (auto& op : Eval::getBinaryOperators ())
+    cli2.entity ("binary_operator", op);
+}
 
-    for (unsigned int i = 0; i < NUM_MODIFIER_NAMES; ++i)
-      cli2.entity ("modifier", modifierNames[i]);
+////////////////////////////////////////////////////////////////////////////////
+// Performs steps [1] to [5] of initialize without a command line, so that the
+// daemon can prepare a Context ahead of the command.
+void Context::warmup (const char* program)
+{
+  const char* argv[] = {program};
+  configure (1, argv);
+  warm = true;
+}
 
-    for (auto& op : Eval::getOperators ())
-      cli2.entity ("operator", op);
+////////////////////////////////////////////////////////////////////////////////
+int Context::initialize (int argc, const char** argv)
+{
+  Profiler::Scope scope ("init");
+  int rc = 0;
 
-    for (auto& op : Eval::getBinaryOperators ())
-      cli2.entity ("binary_operator", op);
+  try
+  {
+    // The daemon has done steps [1] to [5] ahead of the command, so only the
+    // command line overrides remain.
+    if (warm)
+    {
+      CLI2::applyOverrides (argc, argv);
+      verbosity.clear ();
+    }
+    else
+      configure (argc, argv);
 
     ////////////////////////////////////////////////////////////////////////////
     //
@@ -619,25 +653,7 @@ int Context::initialize (int argc, const char** argv)
   // On initialization failure...
   if (rc)
   {
-    // Dump all debug messages, controlled by rc.debug.
-    if (config.getBoolean ("debug"))
-    {
-      for (auto& d : debugMessages)
-        if (color ())
-          std::cerr << colorizeDebug (d) << '\n';
-        else
-          std::cerr << d << '\n';
-    }
-
-    // Dump all headers, controlled by 'header' verbosity token.
-    if (verbose ("header"))
-    {
-      for (auto& h : headers)
-        if (color ())
-          std::cerr << colorizeHeader (h) << '\n';
-        else
-          std::cerr << h << '\n';
-    }
+    writeHeaders ();
 
     // Dump all footnotes, controlled by 'footnote' verbosity token.
     if (verbose ("footnote"))
@@ -658,7 +674,6 @@ int Context::initialize (int argc, const char** argv)
         std::cerr << e << '\n';
   }
 
-  time_init_us += timer_total.total_us ();
   return rc;
 }
 
@@ -675,8 +690,10 @@ int Context::run ()
     tdb2.commit ();           // Harmless if called when nothing changed.
     hooks.onExit ();          // No chance to update data.
 
-    timer_total.stop ();
-    time_total_us += timer_total.total_us ();
+    auto total_us = profiler.total_us ();
+    auto other_us = total_us;
+    for (auto& phase : {"init", "load", "gc", "filter", "commit", "sort", "render", "hooks"})
+      other_us -= profiler.phase_us (phase);
 
     std::stringstream s;
     s << "Perf "
@@ -690,25 +707,20 @@ int Context::run ()
       << ' '
       << Datetime ().toISO ()
 
-      << " init:"   << time_init_us
-      << " load:"   << time_load_us
-      << " gc:"     << (time_gc_us > 0 ? time_gc_us - time_load_us : time_gc_us)
-      << " filter:" << time_filter_us
-      << " commit:" << time_commit_us
-      << " sort:"   << time_sort_us
-      << " render:" << time_render_us
-      << " hooks:"  << time_hooks_us
-      << " other:"  << time_total_us  -
-                       time_init_us   -
-                       time_gc_us     -
-                       time_filter_us -
-                       time_commit_us -
-                       time_sort_us   -
-                       time_render_us -
-                       time_hooks_us
-      << " total:"  << time_total_us
+      << " init:"   << profiler.phase_us ("init")
+      << " load:"   << profiler.phase_us ("load")
+      << " gc:"     << profiler.phase_us ("gc")
+      << " filter:" << profiler.phase_us ("filter")
+      << " commit:" << profiler.phase_us ("commit")
+      << " sort:"   << profiler.phase_us ("sort")
+      << " render:" << profiler.phase_us ("render")
+      << " hooks:"  << profiler.phase_us ("hooks")
+      << " other:"  << other_us
+      << " total:"  << total_us
       << '\n';
     debug (s.str ());
+
+    writeProfile ();
   }
 
   catch (const std::string& message)
@@ -729,25 +741,7 @@ int Context::run ()
     rc = 3;
   }
 
-  // Dump all debug messages, controlled by rc.debug.
-  if (config.getBoolean ("debug"))
-  {
-    for (auto& d : debugMessages)
-      if (color ())
-        std::cerr << colorizeDebug (d) << '\n';
-      else
-        std::cerr << d << '\n';
-  }
-
-  // Dump all headers, controlled by 'header' verbosity token.
-  if (verbose ("header"))
-  {
-    for (auto& h : headers)
-      if (color ())
-        std::cerr << colorizeHeader (h) << '\n';
-      else
-        std::cerr << h << '\n';
-  }
+  writeHeaders ();
 
   // Dump the report output.
   std::cout << output;
@@ -1100,6 +1094,11 @@ void Context::staticInitialization ()
     if (var.substr (0, 13) == "urgency.user." ||
         var.substr (0, 12) == "urgency.uda.")
       Task::coefficients[var] = config.getReal (var);
+
+  Task::compileUrgencyRules ();
+
+  // Date boundaries depend on rc.due, so are recomputed on next use.
+  time_context.reset ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1213,6 +1212,41 @@ void Context::debugTiming (const std::string& details, const Timer& timer)
   debug (out.str ());
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Appends the profile of this command as a line of JSON to the file named by
+// rc.profile, or to the standard error when that is 'stderr'.  The command has
+// completed by now, so a failure to write is reported but does not fail it.
+void Context::writeProfile ()
+{
+  auto target = config.get ("profile");
+  if (target == "")
+    return;
+
+  std::stringstream out;
+  out << "{\"version\":\"" << VERSION << '"'
+      << ",\"commit\":\""
+#ifdef HAVE_COMMIT
+      << COMMIT
+#else
+      << '-'
+#endif
+      << '"'
+      << ",\"date\":\"" << Datetime ().toISO () << '"'
+      << ",\"command\":\"" << json::encode (cli2.getCommand ()) << '"'
+      << ",\"profile\":" << profiler.json ()
+      << "}\n";
+
+  if (target == "stderr")
+  {
+    std::cerr << out.str ();
+    return;
+  }
+
+  File file (target);
+  if (! File::append (file._data, out.str ()))
+    error (format ("Could not write the profile to '{1}'.", file._data));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // This capability is to answer the question of 'what did I just do to generate
 // this output?'.
@@ -1307,6 +1341,44 @@ void Context::error (const std::string& input)
     errors.push_back (input);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Writes output before the command completes, for streamed reports.  Debug
+// messages and headers gathered so far are written first, as run would.
+void Context::output (const std::string& input)
+{
+  writeHeaders ();
+  std::cout << input;
+  std::cout.flush ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes, then discards, the debug messages and headers gathered so far.
+void Context::writeHeaders ()
+{
+  // Dump all debug messages, controlled by rc.debug.
+  if (config.getBoolean ("debug"))
+  {
+    for (auto& d : debugMessages)
+      if (color ())
+        std::cerr << colorizeDebug (d) << '\n';
+      else
+        std::cerr << d << '\n';
+  }
+
+  // Dump all headers, controlled by 'header' verbosity token.
+  if (verbose ("header"))
+  {
+    for (auto& h : headers)
+      if (color ())
+        std::cerr << colorizeHeader (h) << '\n';
+      else
+        std::cerr << h << '\n';
+  }
+
+  debugMessages.clear ();
+  headers.clear ();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void Context::debug (const std::string& input)
 {
@@ -36,6 +36,8 @@
 #include <FS.h>
 #include <CLI2.h>
 #include <Timer.h>
+#include <Profiler.h>
+#include <TimeContext.h>
 #include <set>
 
 class Context
@@ -51,6 +53,7 @@ public:
   static void setContext (Context*);
 
   int initialize (int, const char**);  // all startup
+  void warmup (const char*);           // startup ahead of a command
   int run ();
   int dispatch (std::string&);         // command handler dispatch
 
@@ -67,17 +70,21 @@ public:
   void footnote (const std::string&);  // Footnote message sink
   void debug (const std::string&);     // Debug message sink
   void error (const std::string&);     // Error message sink - non-maskable
+  void output (const std::string&);    // Output written ahead of run
 
   void decomposeSortField (const std::string&, std::string&, bool&, bool&);
   void debugTiming (const std::string&, const Timer&);
 
 private:
+  void configure (int, const char**);
   void staticInitialization ();
   void createDefaultConfig ();
   void updateXtermTitle ();
   void updateVerbosity ();
   void loadAliases ();
   void propagateDebug ();
+  void writeProfile ();
+  void writeHeaders ();
 
   static Context* context;
 
@@ -92,6 +99,7 @@ public:
   bool                                determine_color_use {true};
   bool                                use_color           {true};
   bool                                run_gc              {true};
+  bool                                warm                {false};
   bool                                verbosity_legacy    {false};
   std::set <std::string>              verbosity           {};
   std::vector <std::string>           headers             {};
@@ -103,16 +111,8 @@ public:
   int                                 terminal_width      {0};
   int                                 terminal_height     {0};
 
-  Timer                               timer_total         {};
-  long                                time_total_us       {0};
-  long                                time_init_us        {0};
-  long                                time_load_us        {0};
-  long                                time_gc_us          {0};
-  long                                time_filter_us      {0};
-  long                                time_commit_us      {0};
-  long                                time_sort_us        {0};
-  long                                time_render_us      {0};
-  long                                time_hooks_us       {0};
+  Profiler                            profiler            {};
+  TimeContext                         time_context        {};
 };
 
 #endif
@@ -438,6 +438,278 @@ bool getDOM (const std::string& name, const Task& task, Variant& value)
   return getDOM (name, value);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Binds the reference using the same resolution as getDOM, but without a task.
+// References to other tasks by ID or UUID, and any form that is not handled
+// directly, remain a full lookup.
+DOMAccessor::DOMAccessor (const std::string& name)
+: _name (name)
+, _source (AttributeMap::intern (name))
+{
+  if (name == "")
+    return;
+
+  if (name == "id")
+  {
+    _kind = Kind::id;
+    return;
+  }
+
+  if (name == "urgency")
+  {
+    _kind = Kind::urgency;
+    return;
+  }
+
+  auto elements = split (name, '.');
+
+  Lexer lexer (elements[0]);
+  std::string token;
+  Lexer::Type type;
+  if (lexer.token (token, type))
+  {
+    if ((type == Lexer::Type::uuid &&
+         token.length () == elements[0].length ()) ||
+        (type == Lexer::Type::number &&
+         token.find ('.') == std::string::npos))
+      return;
+  }
+
+  auto size = elements.size ();
+
+  std::string canonical;
+  if ((size == 1 || size == 2) && Context::getContext ().cli2.canonicalize (canonical, "attribute", elements[0]))
+  {
+    if (size == 1 && canonical == "id")
+    {
+      _kind = Kind::id;
+      return;
+    }
+
+    if (size == 1 && canonical == "urgency")
+    {
+      _kind = Kind::urgency;
+      return;
+    }
+
+    auto c = Context::getContext ().columns.find (canonical);
+    Column* column = c != Context::getContext ().columns.end () ? c->second : nullptr;
+
+    if (size == 1 && column)
+    {
+      _attribute = canonical;
+      _uda = column->is_uda ();
+
+      if (column->type () == "date")
+        _kind = Kind::date;
+      else if (column->type () == "duration" || canonical == "recur")
+        _kind = Kind::duration;
+      else if (column->type () == "numeric")
+        _kind = Kind::numeric;
+      else
+        _kind = Kind::string;
+
+      return;
+    }
+
+    if (size == 2 && canonical == "tags")
+    {
+      _kind = Kind::tag;
+      _element = elements[1];
+      return;
+    }
+
+    if (size == 2 && column && column->type () == "date")
+    {
+      if (elements[1] == "year"    ||
+          elements[1] == "month"   ||
+          elements[1] == "day"     ||
+          elements[1] == "week"    ||
+          elements[1] == "weekday" ||
+          elements[1] == "julian"  ||
+          elements[1] == "hour"    ||
+          elements[1] == "minute"  ||
+          elements[1] == "second")
+      {
+        _kind = Kind::date_part;
+        _attribute = canonical;
+        _element = elements[1];
+      }
+
+      return;
+    }
+  }
+
+  // References that do not depend on any task.
+  if ((size > 1) &&
+      (elements[0] == "rc"      ||
+       elements[0] == "tw"      ||
+       elements[0] == "context" ||
+       elements[0] == "system"))
+    _kind = Kind::context;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DOMAccessor::get (const Task& task, Variant& value) const
+{
+  // An empty task has no attributes, which getDOM already handles.
+  if (_kind == Kind::lookup  ||
+      _kind == Kind::context ||
+      ! task.data.size ())
+  {
+    if (! (_kind == Kind::context ? getDOM (_name, value)
+                                  : getDOM (_name, task, value)))
+      return false;
+
+    value.source (_source);
+    return true;
+  }
+
+  switch (_kind)
+  {
+  case Kind::id:
+    value = Variant (static_cast<int> (task.id));
+    break;
+
+  case Kind::urgency:
+    value = Variant (task.urgency_c ());
+    break;
+
+  case Kind::string:
+    if (_uda && ! task.has (_attribute))
+      value = Variant ("");
+    else
+      value = Variant (task.get_ref (_attribute));
+    break;
+
+  case Kind::numeric:
+    if (_uda && ! task.has (_attribute))
+      value = Variant ("");
+    else
+      value = Variant (task.get_float (_attribute));
+    break;
+
+  case Kind::date:
+    {
+      auto numeric = task.get_date (_attribute);
+      if (numeric == 0)
+        value = Variant ("");
+      else
+        value = Variant (numeric, Variant::type_date);
+    }
+    break;
+
+  case Kind::duration:
+    {
+      if (_uda && ! task.has (_attribute))
+      {
+        value = Variant ("");
+        break;
+      }
+
+      const auto& period = task.get_ref (_attribute);
+
+      Duration iso;
+      std::string::size_type cursor = 0;
+      if (iso.parse (period, cursor))
+        value = Variant (iso.toTime_t (), Variant::type_duration);
+      else
+        value = Variant (Duration (period).toTime_t (), Variant::type_duration);
+    }
+    break;
+
+  case Kind::tag:
+    value = Variant (task.hasTag (_element) ? _element : "");
+    break;
+
+  case Kind::date_part:
+    {
+      // Broken down with localtime_r, rather than by Datetime, which uses
+      // static storage, so that this may be done on several threads.
+      time_t epoch = task.get_date (_attribute);
+      if (_element == "week")
+      {
+        value = Variant (static_cast<int> (Datetime (epoch).week ()));
+        break;
+      }
+
+      struct tm t;
+      localtime_r (&epoch, &t);
+           if (_element == "year")    value = Variant (t.tm_year + 1900);
+      else if (_element == "month")   value = Variant (t.tm_mon + 1);
+      else if (_element == "day")     value = Variant (t.tm_mday);
+      else if (_element == "weekday") value = Variant (t.tm_wday);
+      else if (_element == "julian")  value = Variant (t.tm_yday + 1);
+      else if (_element == "hour")    value = Variant (t.tm_hour);
+      else if (_element == "minute")  value = Variant (t.tm_min);
+      else                            value = Variant (t.tm_sec);
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  value.source (_source);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::string& DOMAccessor::name () const
+{
+  return _name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Direct reads of a task are safe to run concurrently, except for the week of
+// a date, which Datetime computes through static storage, and where other
+// tasks are consulted.
+bool DOMAccessor::threadSafe () const
+{
+  switch (_kind)
+  {
+  case Kind::id:
+  case Kind::string:
+  case Kind::numeric:
+  case Kind::date:
+  case Kind::duration:
+    return true;
+
+  case Kind::date_part:
+    return _element != "week";
+
+  case Kind::tag:
+    return ! virtualTag (_element);
+
+  case Kind::urgency:
+    return ! Context::getContext ().config.getBoolean ("urgency.inherit");
+
+  default:
+    return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether the value read is a date, or empty.
+bool DOMAccessor::date () const
+{
+  return _kind == Kind::date;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static.  Virtual tags are all upper case.
+bool DOMAccessor::virtualTag (const std::string& name)
+{
+  if (name == "")
+    return false;
+
+  for (auto& c : name)
+    if (c < 'A' || c > 'Z')
+      return false;
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // DOM Class
 //
@@ -35,6 +35,37 @@
 bool getDOM (const std::string&, Variant&);
 bool getDOM (const std::string&, const Task&, Variant&);
 
+// A DOM reference resolved once, then read from any number of tasks.  Plain
+// attributes, tags and date elements are read directly from the task, while
+// anything else is delegated to getDOM.
+class DOMAccessor
+{
+public:
+  explicit DOMAccessor (const std::string&);
+  bool get (const Task&, Variant&) const;
+  const std::string& name () const;
+  bool threadSafe () const;
+  bool date () const;
+
+  static bool virtualTag (const std::string&);
+
+private:
+  enum class Kind
+  {
+    lookup, context,
+    id, urgency,
+    string, numeric, date, duration,
+    tag, date_part
+  };
+
+  std::string        _name      {};
+  const std::string* _source    {nullptr};  // Interned _name
+  Kind               _kind      {Kind::lookup};
+  std::string        _attribute {};
+  std::string        _element   {};
+  bool               _uda       {false};
+};
+
 class DOM
 {
 public:
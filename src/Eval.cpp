@@ -34,7 +34,7 @@
 #include <shared.h>
 #include <format.h>
 
-extern Task& contextTask;
+extern const Task* contextTask;
 
 ////////////////////////////////////////////////////////////////////////////////
 // Supported operators, borrowed from C++, particularly the precedence.
@@ -175,13 +175,26 @@ void Eval::compileExpression (
   infixToPostfix (_compiled);
   if (_debug)
     Context::getContext ().debug ("[1;37;42mFILTER[0m Postfix      " + dump (_compiled));
+
+  // Lower postfix --> instructions, once, for repeated evaluation.
+  lower (_compiled, _program);
+  fold (_program);
+  checkDates (_program);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void Eval::evaluateCompiledExpression (Variant& v)
+void Eval::evaluateCompiledExpression (Variant& v) const
 {
-  // Call the postfix evaluator.
-  evaluatePostfixStack (_compiled, v);
+  evaluateCompiledExpression (*contextTask, v);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Evaluates against the given task, rather than the global context task.  The
+// value stack is per thread, and reused between calls.
+void Eval::evaluateCompiledExpression (const Task& task, Variant& v) const
+{
+  static thread_local std::vector <Variant> stack;
+  execute (_program, task, stack, v);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -190,6 +203,42 @@ void Eval::debug (bool value)
   _debug = value;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// When set, compilation binds DOM references to accessors that read the task
+// being evaluated, in place of any sources other than the named constants.
+void Eval::bindDOM (bool value)
+{
+  _bind = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether the compiled expression may be evaluated from several threads at
+// once.  Debug output and unbound sources rely on shared state.
+bool Eval::threadSafe () const
+{
+  return _program.threadsafe && ! _debug;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Instructions executed per evaluation of the compiled expression.
+size_t Eval::instructionCount () const
+{
+  return _program.instructions.size ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// DOM references looked up per evaluation of the compiled expression.
+size_t Eval::referenceCount () const
+{
+  size_t count = 0;
+  for (const auto& instruction : _program.instructions)
+    if (instruction.op == Opcode::push_source ||
+        instruction.op == Opcode::push_accessor)
+      ++count;
+
+  return count;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Static.
 std::vector <std::string> Eval::getOperators ()
@@ -218,168 +267,496 @@ void Eval::evaluatePostfixStack (
   const std::vector <std::pair <std::string, Lexer::Type>>& tokens,
   Variant& result) const
 {
-  if (tokens.size () == 0)
-    throw std::string ("No expression to evaluate.");
+  Program program;
+  lower (tokens, program);
 
-  // This is stack used by the postfix evaluator.
   std::vector <Variant> values;
+  execute (program, *contextTask, values, result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Translates postfix tokens into instructions.  Operators are resolved to
+// opcodes, literals are cast to their final type and named constants are
+// folded, so that only identifier lookups remain to be done per evaluation.
+// With bindDOM, those lookups are themselves resolved here, to accessors.
+void Eval::lower (
+  const std::vector <std::pair <std::string, Lexer::Type>>& tokens,
+  Program& program) const
+{
+  static const struct
+  {
+    const char* op;
+    Opcode      opcode;
+  } opcodes[] =
+  {
+    // Ordered by anticipated frequency of use.
+    { "and",      Opcode::op_and       },
+    { "or",       Opcode::op_or        },
+    { "&&",       Opcode::op_and       },
+    { "||",       Opcode::op_or        },
+    { "<",        Opcode::op_lt        },
+    { "<=",       Opcode::op_lte       },
+    { ">",        Opcode::op_gt        },
+    { ">=",       Opcode::op_gte       },
+    { "==",       Opcode::op_eq        },
+    { "!==",      Opcode::op_neq       },
+    { "=",        Opcode::op_partial   },
+    { "!=",       Opcode::op_nopartial },
+    { "+",        Opcode::op_add       },
+    { "-",        Opcode::op_sub       },
+    { "*",        Opcode::op_mul       },
+    { "/",        Opcode::op_div       },
+    { "^",        Opcode::op_exp       },
+    { "%",        Opcode::op_mod       },
+    { "xor",      Opcode::op_xor       },
+    { "~",        Opcode::op_match     },
+    { "!~",       Opcode::op_nomatch   },
+    { "_hastag_", Opcode::op_hastag    },
+    { "_notag_",  Opcode::op_notag     },
+  };
+
+  program = Program ();
+  program.instructions.reserve (tokens.size ());
+
   for (const auto& token : tokens)
   {
-    // Unary operators.
-    if (token.second == Lexer::Type::op &&
-        token.first == "!")
+    if (token.second == Lexer::Type::op)
     {
-      if (values.size () < 1)
-        throw std::string ("The expression could not be evaluated.");
+      // The _pos_ operator is a NOP.
+      if (token.first == "_pos_")
+        continue;
 
-      Variant right = values.back ();
-      values.pop_back ();
-      Variant result = ! right;
-      values.push_back (result);
-      if (_debug)
-        Context::getContext ().debug (format ("Eval {1} ↓'{2}' → ↑'{3}'", token.first, (std::string) right, (std::string) result));
+      Opcode opcode = Opcode::op_unsupported;
+           if (token.first == "!")     opcode = Opcode::op_not;
+      else if (token.first == "_neg_") opcode = Opcode::op_neg;
+      else
+      {
+        for (const auto& entry : opcodes)
+        {
+          if (token.first == entry.op)
+          {
+            opcode = entry.opcode;
+            break;
+          }
+        }
+      }
+
+      // Operator names are kept for diagnostics.
+      program.instructions.push_back ({opcode, (unsigned int) program.names.size ()});
+      program.names.push_back (token.first);
+      continue;
     }
-    else if (token.second == Lexer::Type::op &&
-             token.first == "_neg_")
+
+    Variant v (token.first);
+    switch (token.second)
     {
-      if (values.size () < 1)
-        throw std::string ("The expression could not be evaluated.");
+    case Lexer::Type::number:
+      if (Lexer::isAllDigits (token.first))
+      {
+        v.cast (Variant::type_integer);
+        if (_debug)
+          Context::getContext ().debug (format ("Eval literal number ↑'{1}'", (std::string) v));
+      }
+      else
+      {
+        v.cast (Variant::type_real);
+        if (_debug)
+          Context::getContext ().debug (format ("Eval literal decimal ↑'{1}'", (std::string) v));
+      }
+      break;
 
-      Variant right = values.back ();
-      values.pop_back ();
+    case Lexer::Type::dom:
+    case Lexer::Type::identifier:
+      // Named constants are the first source, and never vary, so they are
+      // resolved here.  Everything else is looked up per evaluation.
+      if (namedConstants (token.first, v))
+      {
+        if (_debug)
+          Context::getContext ().debug (format ("Eval identifier source '{1}' → ↑'{2}'", token.first, (std::string) v));
+        break;
+      }
+
+      if (_bind)
+      {
+        program.instructions.push_back ({Opcode::push_accessor, (unsigned int) program.accessors.size ()});
+        program.accessors.push_back (DOMAccessor (token.first));
+        if (! program.accessors.back ().threadSafe ())
+          program.threadsafe = false;
+      }
+      else
+      {
+        program.instructions.push_back ({Opcode::push_source, (unsigned int) program.names.size ()});
+        program.names.push_back (token.first);
+        program.threadsafe = false;
+      }
+      continue;
 
-      Variant result (0);
-      result -= right;
-      values.push_back (result);
+    case Lexer::Type::date:
+      v.cast (Variant::type_date);
+      if (_debug)
+        Context::getContext ().debug (format ("Eval literal date ↑'{1}'", (std::string) v));
+      break;
 
+    case Lexer::Type::duration:
+      v.cast (Variant::type_duration);
       if (_debug)
-        Context::getContext ().debug (format ("Eval {1} ↓'{2}' → ↑'{3}'", token.first, (std::string) right, (std::string) result));
-    }
-    else if (token.second == Lexer::Type::op &&
-             token.first == "_pos_")
-    {
-      // The _pos_ operator is a NOP.
+        Context::getContext ().debug (format ("Eval literal duration ↑'{1}'", (std::string) v));
+      break;
+
+    // Nothing to do, except note possible virtual tags, which may involve
+    // dates.
+    case Lexer::Type::string:
+    default:
+      if (DOMAccessor::virtualTag (token.first))
+        program.threadsafe = false;
       if (_debug)
-        Context::getContext ().debug (format ("[{1}] eval op {2} NOP", values.size (), token.first));
+        Context::getContext ().debug (format ("Eval literal string ↑'{1}'", (std::string) v));
+      break;
     }
 
-    // Binary operators.
-    else if (token.second == Lexer::Type::op)
+    program.instructions.push_back ({Opcode::push_constant, (unsigned int) program.constants.size ()});
+    program.constants.push_back (v);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Dates are compared without shared state, but a date operated on with a
+// string parses or formats it through Datetime, which uses static storage, as
+// does matching against a date.  Such programs are evaluated by one thread.
+void Eval::checkDates (Program& program) const
+{
+  enum class Value { other, date, text };
+  std::vector <Value> stack;
+
+  for (const auto& instruction : program.instructions)
+  {
+    switch (instruction.op)
     {
-      if (values.size () < 2)
-        throw std::string ("The expression could not be evaluated.");
+    case Opcode::push_constant:
+      {
+        auto& constant = program.constants[instruction.operand];
+        stack.push_back (constant.type () == Variant::type_date ? Value::date :
+                         constant.type () == Variant::type_string &&
+                         ! constant.trivial ()                    ? Value::text :
+                                                                    Value::other);
+      }
+      break;
 
-      Variant right = values.back ();
-      values.pop_back ();
-
-      Variant left = values.back ();
-      values.pop_back ();
-
-      // Ordering these by anticipation frequency of use is a good idea.
-      Variant result;
-           if (token.first == "and")      result = left && right;
-      else if (token.first == "or")       result = left || right;
-      else if (token.first == "&&")       result = left && right;
-      else if (token.first == "||")       result = left || right;
-      else if (token.first == "<")        result = left < right;
-      else if (token.first == "<=")       result = left <= right;
-      else if (token.first == ">")        result = left > right;
-      else if (token.first == ">=")       result = left >= right;
-      else if (token.first == "==")       result = left.operator== (right);
-      else if (token.first == "!==")      result = left.operator!= (right);
-      else if (token.first == "=")        result = left.operator_partial (right);
-      else if (token.first == "!=")       result = left.operator_nopartial (right);
-      else if (token.first == "+")        result = left + right;
-      else if (token.first == "-")        result = left - right;
-      else if (token.first == "*")        result = left * right;
-      else if (token.first == "/")        result = left / right;
-      else if (token.first == "^")        result = left ^ right;
-      else if (token.first == "%")        result = left % right;
-      else if (token.first == "xor")      result = left.operator_xor (right);
-      else if (token.first == "~")        result = left.operator_match (right, contextTask);
-      else if (token.first == "!~")       result = left.operator_nomatch (right, contextTask);
-      else if (token.first == "_hastag_") result = left.operator_hastag (right, contextTask);
-      else if (token.first == "_notag_")  result = left.operator_notag (right, contextTask);
-      else
-        throw format ("Unsupported operator '{1}'.", token.first);
+    case Opcode::push_source:
+      stack.push_back (Value::text);
+      break;
 
-      values.push_back (result);
+    case Opcode::push_accessor:
+      stack.push_back (program.accessors[instruction.operand].date () ? Value::date : Value::text);
+      break;
 
-      if (_debug)
-        Context::getContext ().debug (format ("Eval ↓'{1}' {2} ↓'{3}' → ↑'{4}'", (std::string) left, token.first, (std::string) right, (std::string) result));
+    case Opcode::op_not:
+    case Opcode::op_neg:
+      if (stack.empty ())
+        return;
+      break;
+
+    case Opcode::op_match_constant:
+    case Opcode::op_nomatch_constant:
+      if (stack.empty ())
+        return;
+
+      if (stack.back () == Value::date)
+        program.threadsafe = false;
+
+      stack.back () = Value::other;
+      break;
+
+    default:
+      {
+        if (stack.size () < 2)
+          return;
+
+        auto right = stack.back ();
+        stack.pop_back ();
+        auto left = stack.back ();
+
+        if ((left == Value::date || right == Value::date) &&
+            (left == Value::text || right == Value::text ||
+             instruction.op == Opcode::op_match          ||
+             instruction.op == Opcode::op_nomatch))
+          program.threadsafe = false;
+
+        // Arithmetic on a date is a date.
+        auto arithmetic = instruction.op == Opcode::op_add ||
+                          instruction.op == Opcode::op_sub ||
+                          instruction.op == Opcode::op_mul ||
+                          instruction.op == Opcode::op_div ||
+                          instruction.op == Opcode::op_exp ||
+                          instruction.op == Opcode::op_mod;
+        stack.back () = arithmetic && (left == Value::date || right == Value::date) ? Value::date : Value::other;
+      }
+      break;
     }
+  }
+}
 
-    // Literals and identifiers.
-    else
+////////////////////////////////////////////////////////////////////////////////
+// Evaluates operators whose operands are all constants, such as '( now + 1wk )',
+// replacing them with their result, so that a compiled expression does no
+// arithmetic on literals per task.  Operators that consult the task are left
+// alone, as is anything that fails, so that the error is raised, if at all,
+// when the expression is evaluated.
+void Eval::fold (Program& program) const
+{
+  static const Task none;
+
+  std::vector <Instruction> folded;
+  folded.reserve (program.instructions.size ());
+
+  // Whether each value on the stack is a constant, which is then the last
+  // instruction in folded.
+  std::vector <bool> constant;
+
+  for (const auto& instruction : program.instructions)
+  {
+    switch (instruction.op)
     {
-      Variant v (token.first);
-      switch (token.second)
+    case Opcode::push_constant:
+      folded.push_back (instruction);
+      constant.push_back (true);
+      break;
+
+    case Opcode::push_source:
+    case Opcode::push_accessor:
+      folded.push_back (instruction);
+      constant.push_back (false);
+      break;
+
+    case Opcode::op_unsupported:
+    case Opcode::op_match_constant:
+    case Opcode::op_nomatch_constant:
+      return;
+
+    case Opcode::op_not:
+    case Opcode::op_neg:
+      if (constant.size () < 1)
+        return;
+
+      if (constant.back ())
       {
-      case Lexer::Type::number:
-        if (Lexer::isAllDigits (token.first))
+        try
         {
-          v.cast (Variant::type_integer);
+          auto value = unary (instruction, program.constants[folded.back ().operand]);
           if (_debug)
-            Context::getContext ().debug (format ("Eval literal number ↑'{1}'", (std::string) v));
+            Context::getContext ().debug (format ("Eval fold {1} → ↑'{2}'", program.names[instruction.operand], (std::string) value));
+
+          folded.back ().operand = (unsigned int) program.constants.size ();
+          program.constants.push_back (value);
+          break;
         }
-        else
+
+        catch (...)
+        {
+        }
+      }
+
+      folded.push_back (instruction);
+      constant.back () = false;
+      break;
+
+    default:
+      if (constant.size () < 2)
+        return;
+
+      if (constant[constant.size () - 2] &&
+          constant.back ()               &&
+          instruction.op != Opcode::op_match   &&
+          instruction.op != Opcode::op_nomatch &&
+          instruction.op != Opcode::op_hastag  &&
+          instruction.op != Opcode::op_notag)
+      {
+        try
         {
-          v.cast (Variant::type_real);
+          auto& left  = program.constants[folded[folded.size () - 2].operand];
+          auto& right = program.constants[folded.back ().operand];
+          auto value = binary (program, instruction, left, right, none);
           if (_debug)
-            Context::getContext ().debug (format ("Eval literal decimal ↑'{1}'", (std::string) v));
+            Context::getContext ().debug (format ("Eval fold ↓'{1}' {2} ↓'{3}' → ↑'{4}'", (std::string) left, program.names[instruction.operand], (std::string) right, (std::string) value));
+
+          folded.pop_back ();
+          folded.back ().operand = (unsigned int) program.constants.size ();
+          program.constants.push_back (value);
+          constant.pop_back ();
+          break;
         }
-        break;
 
-      case Lexer::Type::op:
-        throw std::string ("Operator expected.");
-        break;
+        catch (...)
+        {
+        }
+      }
 
-      case Lexer::Type::dom:
-      case Lexer::Type::identifier:
+      // A constant pattern is prepared once, and the match becomes a unary
+      // operator on the left operand.
+      if (constant.back () &&
+          (instruction.op == Opcode::op_match ||
+           instruction.op == Opcode::op_nomatch))
+      {
+        try
         {
-          bool found = false;
-          for (auto source = _sources.begin (); source != _sources.end (); ++source)
-          {
-            if ((*source) (token.first, v))
-            {
-              if (_debug)
-                Context::getContext ().debug (format ("Eval identifier source '{1}' → ↑'{2}'", token.first, (std::string) v));
-              found = true;
-              break;
-            }
-          }
+          auto& right = program.constants[folded.back ().operand];
+          auto matcher = std::make_shared <const Matcher> (right.matcher ());
+          if (_debug)
+            Context::getContext ().debug (format ("Eval fold {1} pattern '{2}'", program.names[instruction.operand], matcher->pattern ()));
+
+          folded.back () = {instruction.op == Opcode::op_match ? Opcode::op_match_constant
+                                                               : Opcode::op_nomatch_constant,
+                            (unsigned int) program.matchers.size ()};
+          program.matchers.push_back (matcher);
+          constant.pop_back ();
+          constant.back () = false;
+          break;
+        }
 
-          // An identifier that fails lookup is a string.
-          if (! found)
+        catch (...)
+        {
+        }
+      }
+
+      folded.push_back (instruction);
+      constant.pop_back ();
+      constant.back () = false;
+      break;
+    }
+  }
+
+  program.instructions.swap (folded);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs a compiled program.  The value stack is supplied by the caller, so that
+// its storage can be reused across evaluations.
+void Eval::execute (
+  const Program& program,
+  const Task& task,
+  std::vector <Variant>& values,
+  Variant& result) const
+{
+  if (program.instructions.size () == 0)
+    throw std::string ("No expression to evaluate.");
+
+  values.clear ();
+  for (const auto& instruction : program.instructions)
+  {
+    switch (instruction.op)
+    {
+    case Opcode::push_constant:
+      values.push_back (program.constants[instruction.operand]);
+      break;
+
+    case Opcode::push_source:
+      {
+        const std::string& name = program.names[instruction.operand];
+        values.emplace_back ();
+        Variant& v = values.back ();
+
+        bool found = false;
+        for (auto source = _sources.begin (); source != _sources.end (); ++source)
+        {
+          if ((*source) (name, v))
           {
-            v.cast (Variant::type_string);
             if (_debug)
-              Context::getContext ().debug (format ("Eval identifier source failed '{1}'", token.first));
+              Context::getContext ().debug (format ("Eval identifier source '{1}' → ↑'{2}'", name, (std::string) v));
+            found = true;
+            break;
           }
         }
-        break;
 
-      case Lexer::Type::date:
-        v.cast (Variant::type_date);
-        if (_debug)
-          Context::getContext ().debug (format ("Eval literal date ↑'{1}'", (std::string) v));
-        break;
+        // An identifier that fails lookup is a string.
+        if (! found)
+        {
+          v = Variant (name);
+          if (_debug)
+            Context::getContext ().debug (format ("Eval identifier source failed '{1}'", name));
+        }
+      }
+      break;
+
+    case Opcode::push_accessor:
+      {
+        const DOMAccessor& accessor = program.accessors[instruction.operand];
+        values.emplace_back ();
+        Variant& v = values.back ();
+
+        if (accessor.get (task, v))
+        {
+          if (_debug)
+            Context::getContext ().debug (format ("Eval identifier accessor '{1}' → ↑'{2}'", accessor.name (), (std::string) v));
+        }
+        else
+        {
+          // An identifier that fails lookup is a string.
+          v = Variant (accessor.name ());
+          if (_debug)
+            Context::getContext ().debug (format ("Eval identifier accessor failed '{1}'", accessor.name ()));
+        }
+      }
+      break;
+
+    case Opcode::op_unsupported:
+      if (values.size () < 2)
+        throw std::string ("The expression could not be evaluated.");
+      throw format ("Unsupported operator '{1}'.", program.names[instruction.operand]);
+
+    // Unary operators, applied in place.
+    case Opcode::op_not:
+    case Opcode::op_neg:
+      {
+        if (values.size () < 1)
+          throw std::string ("The expression could not be evaluated.");
+
+        Variant& right = values.back ();
+        Variant value = unary (instruction, right);
 
-      case Lexer::Type::duration:
-        v.cast (Variant::type_duration);
         if (_debug)
-          Context::getContext ().debug (format ("Eval literal duration ↑'{1}'", (std::string) v));
-        break;
+          Context::getContext ().debug (format ("Eval {1} ↓'{2}' → ↑'{3}'", program.names[instruction.operand], (std::string) right, (std::string) value));
+
+        right = std::move (value);
+      }
+      break;
+
+    // Matches against a prepared pattern, applied in place.
+    case Opcode::op_match_constant:
+    case Opcode::op_nomatch_constant:
+      {
+        if (values.size () < 1)
+          throw std::string ("The expression could not be evaluated.");
+
+        Variant& left = values.back ();
+        const Matcher& matcher = *program.matchers[instruction.operand];
+        Variant value = instruction.op == Opcode::op_match_constant
+                        ? left.operator_match (matcher, task)
+                        : left.operator_nomatch (matcher, task);
 
-      // Nothing to do.
-      case Lexer::Type::string:
-      default:
         if (_debug)
-          Context::getContext ().debug (format ("Eval literal string ↑'{1}'", (std::string) v));
-        break;
+          Context::getContext ().debug (format ("Eval ↓'{1}' {2} ↓'{3}' → ↑'{4}'", (std::string) left, (instruction.op == Opcode::op_match_constant ? "~" : "!~"), matcher.pattern (), (std::string) value));
+
+        left = std::move (value);
       }
+      break;
+
+    // Binary operators, replacing the left operand.
+    default:
+      {
+        if (values.size () < 2)
+          throw std::string ("The expression could not be evaluated.");
+
+        Variant& left        = values[values.size () - 2];
+        const Variant& right = values.back ();
+        Variant value = binary (program, instruction, left, right, task);
+
+        if (_debug)
+          Context::getContext ().debug (format ("Eval ↓'{1}' {2} ↓'{3}' → ↑'{4}'", (std::string) left, program.names[instruction.operand], (std::string) right, (std::string) value));
 
-      values.push_back (v);
+        left = std::move (value);
+        values.pop_back ();
+      }
+      break;
     }
   }
 
@@ -388,7 +765,56 @@ void Eval::evaluatePostfixStack (
   if (values.size () != 1)
     throw std::string ("The value is not an expression.");
 
-  result = values[0];
+  result = std::move (values[0]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Variant Eval::unary (
+  const Instruction& instruction,
+  const Variant& right) const
+{
+  if (instruction.op == Opcode::op_not)
+    return ! right;
+
+  Variant result (0);
+  result -= right;
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Variant Eval::binary (
+  const Program& program,
+  const Instruction& instruction,
+  const Variant& left,
+  const Variant& right,
+  const Task& task) const
+{
+  switch (instruction.op)
+  {
+  case Opcode::op_and:       return left && right;
+  case Opcode::op_or:        return left || right;
+  case Opcode::op_lt:        return left < right;
+  case Opcode::op_lte:       return left <= right;
+  case Opcode::op_gt:        return left > right;
+  case Opcode::op_gte:       return left >= right;
+  case Opcode::op_eq:        return left.operator== (right);
+  case Opcode::op_neq:       return left.operator!= (right);
+  case Opcode::op_partial:   return left.operator_partial (right);
+  case Opcode::op_nopartial: return left.operator_nopartial (right);
+  case Opcode::op_add:       return left + right;
+  case Opcode::op_sub:       return left - right;
+  case Opcode::op_mul:       return left * right;
+  case Opcode::op_div:       return left / right;
+  case Opcode::op_exp:       return left ^ right;
+  case Opcode::op_mod:       return left % right;
+  case Opcode::op_xor:       return left.operator_xor (right);
+  case Opcode::op_match:     return left.operator_match (right, task);
+  case Opcode::op_nomatch:   return left.operator_nomatch (right, task);
+  case Opcode::op_hastag:    return left.operator_hastag (right, task);
+  case Opcode::op_notag:     return left.operator_notag (right, task);
+  default:
+    throw format ("Unsupported operator '{1}'.", program.names[instruction.operand]);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
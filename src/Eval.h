@@ -27,10 +27,12 @@
 #ifndef INCLUDED_EVAL
 #define INCLUDED_EVAL
 
+#include <memory>
 #include <vector>
 #include <string>
 #include <Lexer.h>
 #include <Variant.h>
+#include <DOM.h>
 
 class Eval
 {
@@ -41,14 +43,57 @@ public:
   void evaluateInfixExpression (const std::string&, Variant&) const;
   void evaluatePostfixExpression (const std::string&, Variant&) const;
   void compileExpression (const std::vector <std::pair <std::string, Lexer::Type>>&);
-  void evaluateCompiledExpression (Variant&);
+  void evaluateCompiledExpression (Variant&) const;
+  void evaluateCompiledExpression (const Task&, Variant&) const;
   void debug (bool);
+  void bindDOM (bool);
+  bool threadSafe () const;
+  size_t instructionCount () const;
+  size_t referenceCount () const;
 
   static std::vector <std::string> getOperators ();
   static std::vector <std::string> getBinaryOperators ();
 
 private:
+  // Instruction set for compiled expressions.
+  enum class Opcode : unsigned char
+  {
+    push_constant, push_source, push_accessor,
+    op_not, op_neg,
+    op_and, op_or, op_xor,
+    op_lt, op_lte, op_gt, op_gte,
+    op_eq, op_neq, op_partial, op_nopartial,
+    op_add, op_sub, op_mul, op_div, op_exp, op_mod,
+    op_match, op_nomatch, op_hastag, op_notag,
+    op_match_constant, op_nomatch_constant,
+    op_unsupported
+  };
+
+  // The operand indexes the constants, names, accessors or matchers of a
+  // program.
+  struct Instruction
+  {
+    Opcode       op;
+    unsigned int operand;
+  };
+
+  struct Program
+  {
+    std::vector <Instruction> instructions {};
+    std::vector <Variant>     constants    {};
+    std::vector <std::string> names        {};
+    std::vector <DOMAccessor> accessors    {};
+    std::vector <std::shared_ptr <const Matcher>> matchers {};
+    bool                      threadsafe   {true};
+  };
+
   void evaluatePostfixStack (const std::vector <std::pair <std::string, Lexer::Type>>&, Variant&) const;
+  void lower (const std::vector <std::pair <std::string, Lexer::Type>>&, Program&) const;
+  void fold (Program&) const;
+  void checkDates (Program&) const;
+  void execute (const Program&, const Task&, std::vector <Variant>&, Variant&) const;
+  Variant unary (const Instruction&, const Variant&) const;
+  Variant binary (const Program&, const Instruction&, const Variant&, const Variant&, const Task&) const;
   void infixToPostfix (std::vector <std::pair <std::string, Lexer::Type>>&) const;
   void infixParse (std::vector <std::pair <std::string, Lexer::Type>>&) const;
   bool parseLogical (std::vector <std::pair <std::string, Lexer::Type>>&, unsigned int &) const;
@@ -68,7 +113,9 @@ private:
 private:
   std::vector <bool (*)(const std::string&, Variant&)> _sources {};
   bool _debug                                                   {false};
+  bool _bind                                                    {false};
   std::vector <std::pair <std::string, Lexer::Type>> _compiled  {};
+  Program _program                                              {};
 };
 
 #endif
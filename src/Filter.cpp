@@ -27,8 +27,10 @@
 #include <cmake.h>
 #include <Filter.h>
 #include <algorithm>
+#include <exception>
+#include <limits>
+#include <thread>
 #include <Context.h>
-#include <Timer.h>
 #include <DOM.h>
 #include <Eval.h>
 #include <Variant.h>
@@ -38,12 +40,25 @@
 ////////////////////////////////////////////////////////////////////////////////
 // Const iterator that can be derefenced into a Task by domSource.
 static Task dummy;
-Task& contextTask = dummy;
+const Task* contextTask = &dummy;
+
+////////////////////////////////////////////////////////////////////////////////
+ContextTask::ContextTask (const Task& task)
+: _previous (contextTask)
+{
+  contextTask = &task;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ContextTask::~ContextTask ()
+{
+  contextTask = _previous;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 bool domSource (const std::string& identifier, Variant& value)
 {
-  if (getDOM (identifier, contextTask, value))
+  if (getDOM (identifier, *contextTask, value))
   {
     value.source (identifier);
     return true;
@@ -52,11 +67,124 @@ bool domSource (const std::string& identifier, Variant& value)
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Smallest number of tasks worth handing to a thread.
+static const size_t FILTER_CHUNK = 1024;
+
+// Inputs are either tasks, or views of tasks.
+static const Task& deref (const Task& task)  { return task;  }
+static const Task& deref (const Task* task)  { return *task; }
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends the tasks matching the compiled filter to output, in input order.
+// Large sets are split into contiguous ranges, evaluated concurrently, with
+// the matches gathered afterwards so that the order is unchanged.
+template <typename Input>
+static void evaluate (
+  const Eval& eval,
+  const Input& input,
+  std::vector <const Task*>& output)
+{
+  auto& profiler = Context::getContext ().profiler;
+  profiler.count ("filter.tasks", (long) input.size ());
+  profiler.count ("eval.ops",     (long) (input.size () * eval.instructionCount ()));
+  profiler.count ("dom.lookups",  (long) (input.size () * eval.referenceCount ()));
+
+  size_t threads = 1;
+  if (eval.threadSafe ())
+  {
+    auto configured = Context::getContext ().config.getInteger ("filter.threads");
+    threads = configured > 0 ? (size_t) configured : std::thread::hardware_concurrency ();
+    threads = std::max ((size_t) 1, std::min (threads, input.size () / FILTER_CHUNK));
+  }
+
+  if (threads == 1)
+  {
+    for (auto& task : input)
+    {
+      Variant var;
+      eval.evaluateCompiledExpression (deref (task), var);
+      if (var.get_bool ())
+        output.push_back (&deref (task));
+    }
+
+    return;
+  }
+
+  Context::getContext ().debug (format ("Filter evaluating {1} tasks on {2} threads", input.size (), threads));
+
+  // Date boundaries are computed on first use, which must not happen on a
+  // worker thread, as it goes through the non-reentrant Datetime parser.
+  Context::getContext ().time_context.get ();
+
+  std::vector <char> matches (input.size (), 0);
+  std::vector <std::exception_ptr> errors (threads);
+  std::vector <std::thread> pool;
+
+  auto chunk = (input.size () + threads - 1) / threads;
+  for (size_t t = 0; t < threads; ++t)
+  {
+    pool.emplace_back ([&, t] ()
+    {
+      try
+      {
+        auto end = std::min (input.size (), (t + 1) * chunk);
+        for (auto i = t * chunk; i < end; ++i)
+        {
+          Variant var;
+          eval.evaluateCompiledExpression (deref (input[i]), var);
+          matches[i] = var.get_bool () ? 1 : 0;
+        }
+      }
+
+      catch (...)
+      {
+        errors[t] = std::current_exception ();
+      }
+    });
+  }
+
+  for (auto& thread : pool)
+    thread.join ();
+
+  // Report the error from the earliest range, as a serial pass would.
+  for (auto& error : errors)
+    if (error)
+      std::rethrow_exception (error);
+
+  for (size_t i = 0; i < input.size (); ++i)
+    if (matches[i])
+      output.push_back (&deref (input[i]));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Copies the tasks of a view, for callers that modify them.
+static void copy (const std::vector <const Task*>& view, std::vector <Task>& output)
+{
+  output.reserve (output.size () + view.size ());
+  for (auto& task : view)
+    output.push_back (*task);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Take an input set of tasks and filter into a subset.
 void Filter::subset (const std::vector <Task>& input, std::vector <Task>& output)
 {
-  Timer timer;
+  std::vector <const Task*> view;
+  view.reserve (input.size ());
+  for (auto& task : input)
+    view.push_back (&task);
+
+  std::vector <const Task*> matches;
+  subset (view, matches);
+  copy (matches, output);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Take an input set of tasks and filter into a subset.
+void Filter::subset (const std::vector <const Task*>& input, std::vector <const Task*>& output)
+{
+  Profiler::Scope scope ("filter");
   _startCount = (int) input.size ();
 
   Context::getContext ().cli2.prepareFilter ();
@@ -74,18 +202,10 @@ void Filter::subset (const std::vector <Task>& input, std::vector <Task>& output
     // Debug output from Eval during compilation is useful.  During evaluation
     // it is mostly noise.
     eval.debug (Context::getContext ().config.getInteger ("debug.parser") >= 3 ? true : false);
+    eval.bindDOM (true);
     eval.compileExpression (precompiled);
 
-    for (auto& task : input)
-    {
-      // Set up context for any DOM references.
-      contextTask = task;
-
-      Variant var;
-      eval.evaluateCompiledExpression (var);
-      if (var.get_bool ())
-        output.push_back (task);
-    }
+    evaluate (eval, input, output);
 
     eval.debug (false);
   }
@@ -94,14 +214,22 @@ void Filter::subset (const std::vector <Task>& input, std::vector <Task>& output
 
   _endCount = (int) output.size ();
   Context::getContext ().debug (format ("Filtered {1} tasks --> {2} tasks [list subset]", _startCount, _endCount));
-  Context::getContext ().time_filter_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Take the set of all tasks and filter into a subset.
 void Filter::subset (std::vector <Task>& output)
 {
-  Timer timer;
+  std::vector <const Task*> matches;
+  subset (matches);
+  copy (matches, output);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Take the set of all tasks and filter into a subset.
+void Filter::subset (std::vector <const Task*>& output)
+{
+  Profiler::Scope scope ("filter");
   Context::getContext ().cli2.prepareFilter ();
 
   std::vector <std::pair <std::string, Lexer::Type>> precompiled;
@@ -114,9 +242,7 @@ void Filter::subset (std::vector <Task>& output)
 
   if (precompiled.size ())
   {
-    Timer timer_pending;
-    auto pending = Context::getContext ().tdb2.pending.get_tasks ();
-    Context::getContext ().time_filter_us -= timer_pending.total_us ();
+    auto& pending = Context::getContext ().tdb2.pending.get_tasks ();
     _startCount = (int) pending.size ();
 
     Eval eval;
@@ -125,38 +251,22 @@ void Filter::subset (std::vector <Task>& output)
     // Debug output from Eval during compilation is useful.  During evaluation
     // it is mostly noise.
     eval.debug (Context::getContext ().config.getInteger ("debug.parser") >= 3 ? true : false);
+    eval.bindDOM (true);
     eval.compileExpression (precompiled);
 
     output.clear ();
-    for (auto& task : pending)
-    {
-      // Set up context for any DOM references.
-      contextTask = task;
-
-      Variant var;
-      eval.evaluateCompiledExpression (var);
-      if (var.get_bool ())
-        output.push_back (task);
-    }
+    evaluate (eval, pending, output);
 
     shortcut = pendingOnly ();
     if (! shortcut)
     {
-      Timer timer_completed;
-      auto completed = Context::getContext ().tdb2.completed.get_tasks ();
-      Context::getContext ().time_filter_us -= timer_completed.total_us ();
-      _startCount += (int) completed.size ();
-
-      for (auto& task : completed)
-      {
-        // Set up context for any DOM references.
-        contextTask = task;
+      _completed.clear ();
+      const std::vector <Task>* completed = &_completed;
+      if (! indexedCompleted (_completed))
+        completed = &Context::getContext ().tdb2.completed.get_tasks ();
+      _startCount += (int) completed->size ();
 
-        Variant var;
-        eval.evaluateCompiledExpression (var);
-        if (var.get_bool ())
-          output.push_back (task);
-      }
+      evaluate (eval, *completed, output);
     }
 
     eval.debug (false);
@@ -165,18 +275,15 @@ void Filter::subset (std::vector <Task>& output)
   {
     safety ();
 
-    Timer pending_completed;
     for (auto& task : Context::getContext ().tdb2.pending.get_tasks ())
-      output.push_back (task);
+      output.push_back (&task);
 
     for (auto& task : Context::getContext ().tdb2.completed.get_tasks ())
-      output.push_back (task);
-    Context::getContext ().time_filter_us -= pending_completed.total_us ();
+      output.push_back (&task);
   }
 
   _endCount = (int) output.size ();
   Context::getContext ().debug (format ("Filtered {1} tasks --> {2} tasks [{3}]", _startCount, _endCount, (shortcut ? "pending only" : "all tasks")));
-  Context::getContext ().time_filter_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -252,6 +359,142 @@ bool Filter::pendingOnly () const
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Evaluates a date literal, or a parenthesized expression of literals, such as
+// '( now - 1wk )', starting at args[i].
+static bool literalDate (const std::vector <const A2*>& args, unsigned int i, time_t& value)
+{
+  std::vector <std::pair <std::string, Lexer::Type>> tokens;
+  if (args[i]->_lextype == Lexer::Type::date)
+    tokens.push_back (std::pair <std::string, Lexer::Type> (args[i]->getToken (), args[i]->_lextype));
+
+  else if (args[i]->_lextype == Lexer::Type::op &&
+           args[i]->attribute ("raw") == "(")
+  {
+    int depth = 0;
+    for (; i < args.size (); ++i)
+    {
+      auto type = args[i]->_lextype;
+      if (type != Lexer::Type::op       &&
+          type != Lexer::Type::date     &&
+          type != Lexer::Type::duration &&
+          type != Lexer::Type::number)
+        return false;
+
+      tokens.push_back (std::pair <std::string, Lexer::Type> (args[i]->getToken (), type));
+      auto raw = args[i]->attribute ("raw");
+      if (raw == "(")
+        ++depth;
+      else if (raw == ")" && --depth == 0)
+        break;
+    }
+
+    if (depth)
+      return false;
+  }
+  else
+    return false;
+
+  try
+  {
+    Eval eval;
+    eval.compileExpression (tokens);
+
+    Variant result;
+    eval.evaluateCompiledExpression (result);
+    if (result.type () != Variant::type_date)
+      return false;
+
+    value = result.get_date ();
+    return true;
+  }
+
+  catch (const std::string&)
+  {
+    return false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// If completed.data is not yet loaded, and the filter is a conjunction that
+// limits the candidates to a list of UUIDs, or to a range of 'end' or 'entry'
+// dates, then only those candidates are read from completed.data, via its
+// index.  The filter is still applied to every candidate.
+bool Filter::indexedCompleted (std::vector <Task>& output) const
+{
+  auto& context = Context::getContext ();
+  if (context.tdb2.completed._loaded_tasks)
+    return false;
+
+  std::vector <const A2*> args;
+  int countOr  = 0;
+  int countXor = 0;
+  int countNot = 0;
+
+  for (const auto& a : context.cli2._args)
+  {
+    if (a.hasTag ("FILTER"))
+    {
+      args.push_back (&a);
+
+      std::string raw = a.attribute ("raw");
+      if (a._lextype == Lexer::Type::op && raw == "or")              ++countOr;
+      if (a._lextype == Lexer::Type::op && raw == "xor")             ++countXor;
+      if (a._lextype == Lexer::Type::op && (raw == "not" || raw == "!")) ++countNot;
+    }
+  }
+
+  if (countXor || countNot)
+    return false;
+
+  // The UUID list becomes a single clause, joined by 'or', and the rest of the
+  // filter must be joined to it by 'and'.
+  auto& uuids = context.cli2._uuid_list;
+  if (uuids.size ())
+  {
+    if (context.cli2._id_ranges.size () ||
+        countOr != (int) uuids.size () - 1)
+      return false;
+
+    return context.tdb2.completed.get_tasks (uuids, output);
+  }
+
+  if (countOr)
+    return false;
+
+  // Look for '<end|entry> <op> <date>' terms.
+  std::string attribute;
+  int64_t after  = std::numeric_limits <int64_t>::min ();
+  int64_t before = std::numeric_limits <int64_t>::max ();
+
+  for (unsigned int i = 0; i + 2 < args.size (); ++i)
+  {
+    std::string name = args[i]->attribute ("canonical");
+    if (args[i]->_lextype != Lexer::Type::dom           ||
+        (name != "end" && name != "entry")              ||
+        (attribute != "" && attribute != name)          ||
+        args[i + 1]->_lextype != Lexer::Type::op)
+      continue;
+
+    std::string op = args[i + 1]->attribute ("raw");
+    time_t value;
+    if ((op != "<" && op != "<=" && op != ">" && op != ">=") ||
+        ! literalDate (args, i + 2, value))
+      continue;
+
+    attribute = name;
+    if (op[0] == '>')
+      after = std::max (after, (int64_t) value);
+    else
+      before = std::min (before, (int64_t) value);
+  }
+
+  if (attribute == "")
+    return false;
+
+  return context.tdb2.completed.get_tasks (attribute, after, before, output);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Disaster avoidance mechanism. If a !READONLY has no filter, then it can cause
 // all tasks to be modified. This is usually not intended.
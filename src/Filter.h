@@ -34,22 +34,44 @@
 
 bool domSource (const std::string&, Variant&);
 
+// Binds the task that domSource resolves attribute references against, for
+// the lifetime of the object.  The task is referenced, not copied.
+class ContextTask
+{
+public:
+  explicit ContextTask (const Task&);
+  ~ContextTask ();
+
+private:
+  const Task* _previous;
+};
+
 class Filter
 {
 public:
   Filter () = default;
 
+  // The Task* subsets refer to the database, or to tasks held by the Filter,
+  // and remain valid while both are unmodified.
+  void subset (const std::vector <const Task*>&, std::vector <const Task*>&);
   void subset (const std::vector <Task>&, std::vector <Task>&);
+  void subset (std::vector <const Task*>&);
   void subset (std::vector <Task>&);
   bool hasFilter () const;
   bool pendingOnly () const;
   void safety () const;
   void disableSafety ();
 
+private:
+  bool indexedCompleted (std::vector <Task>&) const;
+
 private:
   int  _startCount {0};
   int  _endCount   {0};
   bool _safety     {true};
+
+  // Completed tasks read through the index, rather than the whole file.
+  std::vector <Task> _completed;
 };
 
 #endif
@@ -132,7 +132,7 @@ void Hooks::onLaunch () const
   if (! _enabled)
     return;
 
-  Timer timer;
+  Profiler::Scope scope ("hooks");
 
   std::vector <std::string> matchingScripts = scripts ("on-launch");
   if (matchingScripts.size ())
@@ -164,8 +164,6 @@ void Hooks::onLaunch () const
       }
     }
   }
-
-  Context::getContext ().time_hooks_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -185,7 +183,7 @@ void Hooks::onExit () const
   if (! _enabled)
     return;
 
-  Timer timer;
+  Profiler::Scope scope ("hooks");
 
   std::vector <std::string> matchingScripts = scripts ("on-exit");
   if (matchingScripts.size ())
@@ -226,8 +224,6 @@ void Hooks::onExit () const
       }
     }
   }
-
-  Context::getContext ().time_hooks_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -247,7 +243,7 @@ void Hooks::onAdd (Task& task) const
   if (! _enabled)
     return;
 
-  Timer timer;
+  Profiler::Scope scope ("hooks");
 
   std::vector <std::string> matchingScripts = scripts ("on-add");
   if (matchingScripts.size ())
@@ -291,8 +287,6 @@ void Hooks::onAdd (Task& task) const
     // Transfer the modified task back to the original task.
     task = Task (input[0]);
   }
-
-  Context::getContext ().time_hooks_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -313,7 +307,7 @@ void Hooks::onModify (const Task& before, Task& after) const
   if (! _enabled)
     return;
 
-  Timer timer;
+  Profiler::Scope scope ("hooks");
 
   std::vector <std::string> matchingScripts = scripts ("on-modify");
   if (matchingScripts.size ())
@@ -357,8 +351,6 @@ void Hooks::onModify (const Task& before, Task& after) const
 
     after = Task (input[1]);
   }
-
-  Context::getContext ().time_hooks_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -560,6 +552,8 @@ int Hooks::callHookScript (
   const std::vector <std::string>& input,
   std::vector <std::string>& output) const
 {
+  Context::getContext ().profiler.count ("hooks.run");
+
   if (_debug >= 1)
     Context::getContext ().debug ("Hook: Calling " + script);
 
@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Matcher.h>
+#include <shared.h>
+
+// Characters with a meaning in an extended regular expression.
+static const char* metacharacters = ".[]()*+?{}|^$\\";
+
+////////////////////////////////////////////////////////////////////////////////
+// Case folding as done by find () and REG_ICASE, in the C locale.
+static inline unsigned char fold (unsigned char c)
+{
+  return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Matcher::Searcher::Searcher (const std::string& needle, bool sensitive)
+: _needle (needle)
+, _sensitive (sensitive)
+{
+  if (! _sensitive)
+    for (auto& c : _needle)
+      c = fold (c);
+
+  // Distance to shift when a byte is the last of the window.
+  auto length = _needle.length ();
+  for (auto& skip : _skip)
+    skip = length;
+
+  for (std::string::size_type i = 0; i + 1 < length; ++i)
+    _skip[(unsigned char) _needle[i]] = length - 1 - i;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Returns the position of the first occurrence, or npos, as find () does.
+std::string::size_type Matcher::Searcher::find (const std::string& text) const
+{
+  auto length = _needle.length ();
+  if (length == 0)
+    return ::find (text, _needle, _sensitive);
+
+  if (text.length () < length)
+    return std::string::npos;
+
+  auto needle = (const unsigned char*) _needle.data ();
+  auto data   = (const unsigned char*) text.data ();
+  auto last   = text.length () - length;
+
+  for (std::string::size_type start = 0; start <= last; )
+  {
+    auto c = _sensitive ? data[start + length - 1] : fold (data[start + length - 1]);
+    if (c == needle[length - 1])
+    {
+      std::string::size_type i = 0;
+      if (_sensitive)
+        while (i < length - 1 && data[start + i] == needle[i])
+          ++i;
+      else
+        while (i < length - 1 && fold (data[start + i]) == needle[i])
+          ++i;
+
+      if (i == length - 1)
+        return start;
+    }
+
+    start += _skip[c];
+  }
+
+  return std::string::npos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The pattern is a regular expression, or with regex false, a substring that
+// may be anchored by a leading '^' or a trailing '$'.
+Matcher::Matcher (const std::string& pattern, bool sensitive, bool regex)
+: _pattern (pattern)
+, _sensitive (sensitive)
+, _regex (regex)
+, _literal (! regex || pattern.find_first_of (metacharacters) == std::string::npos)
+, _rx (nullptr)
+, _whole (pattern, sensitive)
+{
+  // Compiled up front, so that matching does not modify the RX, and may be
+  // done concurrently.
+  if (! _literal)
+  {
+    _rx = std::make_shared <RX> (_pattern, _sensitive);
+    _rx->match ("");
+  }
+
+  if (! _regex && _pattern.length ())
+  {
+    _head = Searcher (_pattern.substr (1), _sensitive);
+    _tail = Searcher (_pattern.substr (0, _pattern.length () - 1), _sensitive);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Matches text against the pattern as a whole, anchors included.
+bool Matcher::match (const std::string& text) const
+{
+  if (_regex)
+    return search (text);
+
+  // If pattern starts with '^', look for a leftmost compare only.
+  if (_pattern[0] == '^' &&
+      _head.find (text) == 0)
+    return true;
+
+  // If pattern ends with '$', look for a rightmost compare only.
+  else if (_pattern.length ()                       &&
+           _pattern[_pattern.length () - 1] == '$' &&
+           _tail.find (text) == (text.length () - _pattern.length () + 1))
+    return true;
+
+  return _whole.find (text) != std::string::npos;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Looks for the pattern anywhere in text.  Without regex, anchors are not
+// treated specially.
+bool Matcher::search (const std::string& text) const
+{
+  if (_literal)
+    return _whole.find (text) != std::string::npos;
+
+  return _rx->match (text);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::string& Matcher::pattern () const
+{
+  return _pattern;
+}
+
+////////////////////////////////////////////////////////////////////////////////
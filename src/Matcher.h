@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_MATCHER
+#define INCLUDED_MATCHER
+
+#include <memory>
+#include <string>
+#include <RX.h>
+
+// Matcher is the compiled form of the right operand of '~', so that a pattern
+// applied to many tasks is prepared once.  Regular expressions are compiled
+// once, and patterns without regex metacharacters are instead searched for
+// directly, with a Boyer-Moore-Horspool skip table.  Copies share the one
+// compiled RX, as copying an RX discards its compiled form.
+class Matcher
+{
+public:
+  Matcher (const std::string&, bool, bool);
+
+  bool match (const std::string&) const;
+  bool search (const std::string&) const;
+  const std::string& pattern () const;
+
+private:
+  // A literal needle, with its skip table.
+  class Searcher
+  {
+  public:
+    Searcher () = default;
+    Searcher (const std::string&, bool);
+    std::string::size_type find (const std::string&) const;
+
+  private:
+    std::string            _needle          {};
+    bool                   _sensitive       {true};
+    std::string::size_type _skip[256]       {};
+  };
+
+  std::string          _pattern;
+  bool                 _sensitive;
+  bool                 _regex;
+  bool                 _literal;
+  std::shared_ptr <RX> _rx;
+  Searcher             _whole;
+  Searcher             _head;
+  Searcher             _tail;
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,219 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cmake.h>
+#include <Profiler.h>
+#include <sstream>
+#include <Context.h>
+#include <JSON.h>
+
+std::atomic <bool> Profiler::_counting    {false};
+std::atomic <long> Profiler::_allocations {0};
+
+////////////////////////////////////////////////////////////////////////////////
+Profiler::Scope::Scope (const std::string& name)
+: _allocations (Profiler::allocations ())
+{
+  Context::getContext ().profiler.enter (name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Profiler::Scope::~Scope ()
+{
+  Context::getContext ().profiler.leave (_timer.total_us (), Profiler::allocations () - _allocations);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The root phase covers the whole command, and is timed from construction.
+Profiler::Profiler ()
+{
+  _nodes.push_back (Node ());
+  _nodes[0].name = "total";
+  _nodes[0].calls = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Counters accumulate in the innermost open phase.
+void Profiler::count (const std::string& name, long value)
+{
+  _nodes[_current].counters[name] += value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Time spent in all phases of that name, excluding the phases nested in them,
+// so that the phases of a command sum to its total.
+long Profiler::phase_us (const std::string& name) const
+{
+  long us = 0;
+  for (size_t i = 0; i < _nodes.size (); ++i)
+    if (_nodes[i].name == name)
+      us += self_us (i);
+
+  return us;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long Profiler::total_us () const
+{
+  return (long) _timer.total_us ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Composes the profile as a single line of JSON:
+//
+//   {"total_us":...,"allocations":...,
+//    "phases":{"<name>":<self us>,...},
+//    "counters":{"<name>":<sum>,...},
+//    "scopes":{"name":"total","us":...,"self_us":...,"calls":...,
+//              "allocations":...,"counters":{...},"children":[...]}}
+//
+std::string Profiler::json () const
+{
+  std::map <std::string, long> phases;
+  std::map <std::string, long> counters;
+  for (size_t i = 0; i < _nodes.size (); ++i)
+  {
+    phases[_nodes[i].name] += self_us (i);
+    for (auto& counter : _nodes[i].counters)
+      counters[counter.first] += counter.second;
+  }
+
+  std::stringstream out;
+  out << "{\"total_us\":" << total_us ()
+      << ",\"allocations\":" << allocations ()
+      << ",\"phases\":{";
+
+  bool first = true;
+  for (auto& phase : phases)
+  {
+    out << (first ? "" : ",") << '"' << json::encode (phase.first) << "\":" << phase.second;
+    first = false;
+  }
+
+  out << "},\"counters\":{";
+
+  first = true;
+  for (auto& counter : counters)
+  {
+    out << (first ? "" : ",") << '"' << json::encode (counter.first) << "\":" << counter.second;
+    first = false;
+  }
+
+  out << "},\"scopes\":" << json (0) << '}';
+  return out.str ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static.  Allocations are only counted when a profile is wanted.  Set before
+// any other threads start.
+void Profiler::count_allocations (bool counting)
+{
+  _counting.store (counting, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Static.
+long Profiler::allocations ()
+{
+  return _allocations.load (std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Opens the named phase beneath the current one, reusing it when the same
+// phase is entered repeatedly.
+void Profiler::enter (const std::string& name)
+{
+  for (auto child : _nodes[_current].children)
+  {
+    if (_nodes[child].name == name)
+    {
+      _current = child;
+      return;
+    }
+  }
+
+  Node node;
+  node.name = name;
+  node.parent = _current;
+  _nodes.push_back (node);
+  _nodes[_current].children.push_back (_nodes.size () - 1);
+  _current = _nodes.size () - 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Profiler::leave (long us, long allocations)
+{
+  auto& node = _nodes[_current];
+  node.us += us;
+  node.allocations += allocations;
+  ++node.calls;
+  _current = node.parent;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long Profiler::self_us (size_t index) const
+{
+  long us = index ? _nodes[index].us : total_us ();
+  for (auto child : _nodes[index].children)
+    us -= _nodes[child].us;
+
+  return us;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::string Profiler::json (size_t index) const
+{
+  auto& node = _nodes[index];
+
+  std::stringstream out;
+  out << "{\"name\":\"" << json::encode (node.name) << '"'
+      << ",\"us\":" << (index ? node.us : total_us ())
+      << ",\"self_us\":" << self_us (index)
+      << ",\"calls\":" << node.calls
+      << ",\"allocations\":" << (index ? node.allocations : allocations ())
+      << ",\"counters\":{";
+
+  bool first = true;
+  for (auto& counter : node.counters)
+  {
+    out << (first ? "" : ",") << '"' << json::encode (counter.first) << "\":" << counter.second;
+    first = false;
+  }
+
+  out << "},\"children\":[";
+
+  first = true;
+  for (auto child : node.children)
+  {
+    out << (first ? "" : ",") << json (child);
+    first = false;
+  }
+
+  out << "]}";
+  return out.str ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
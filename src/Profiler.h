@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef INCLUDED_PROFILER
+#define INCLUDED_PROFILER
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+#include <Timer.h>
+
+// Profiler records the nested phases of a command, with the time spent, the
+// allocations made and the counters accumulated in each.
+class Profiler
+{
+public:
+  // Times the enclosing block as a phase of the current one.
+  class Scope
+  {
+  public:
+    explicit Scope (const std::string&);
+    ~Scope ();
+
+  private:
+    Timer _timer        {};
+    long  _allocations  {0};
+  };
+
+  Profiler ();
+  void count (const std::string&, long = 1);
+  long phase_us (const std::string&) const;
+  long total_us () const;
+  std::string json () const;
+
+  // Called for every allocation, by the binaries that count them, so the
+  // check is inline, and cheap while counting is off.
+  static void allocation ()
+  {
+    if (_counting.load (std::memory_order_relaxed))
+      _allocations.fetch_add (1, std::memory_order_relaxed);
+  }
+
+  static void count_allocations (bool);
+  static long allocations ();
+
+private:
+  struct Node
+  {
+    std::string                  name        {};
+    size_t                       parent      {0};
+    long                         us          {0};
+    long                         calls       {0};
+    long                         allocations {0};
+    std::map <std::string, long> counters    {};
+    std::vector <size_t>         children    {};
+  };
+
+  void enter (const std::string&);
+  void leave (long, long);
+  long self_us (size_t) const;
+  std::string json (size_t) const;
+
+private:
+  std::vector <Node> _nodes   {};
+  size_t             _current {0};
+  Timer              _timer   {};
+
+  static std::atomic <bool> _counting;
+  static std::atomic <long> _allocations;
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
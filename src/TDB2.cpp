@@ -27,12 +27,20 @@
 #include <cmake.h>
 #include <TDB2.h>
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <list>
 #include <set>
 #include <stdlib.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <limits>
+#include <thread>
 #include <Context.h>
 #include <Color.h>
 #include <Datetime.h>
@@ -46,6 +54,228 @@
 
 bool TDB2::debug_mode = false;
 
+// Smallest number of lines worth handing to a parsing thread.
+static const size_t LOAD_CHUNK = 4096;
+
+////////////////////////////////////////////////////////////////////////////////
+// Snapshot files hold the already-parsed form of a data file, so that a load
+// can skip the FF4 parse entirely.  The layout is native-endian and flat, so
+// the whole file can be mapped and walked in place:
+//
+//   header  magic[8] "TWSNAP\0\0"
+//           uint32   version
+//           uint32   task count
+//           uint64   source file size
+//           int64    source file mtime
+//           uint64   source file hash
+//   task    uint32   attribute count
+//           { uint32 name length, name, uint32 value length, value } ...
+//
+// A snapshot is only used if size, mtime and hash all match the data file,
+// otherwise it is ignored, and rewritten after the data file is parsed.
+static const char     SNAPSHOT_MAGIC[8] = {'T', 'W', 'S', 'N', 'A', 'P', 0, 0};
+static const uint32_t SNAPSHOT_VERSION  = 1;
+
+struct SnapshotHeader
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t count;
+  uint64_t size;
+  int64_t  mtime;
+  uint64_t hash;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// FNV-1a over the lines of a file, including the newlines stripped on read.
+static uint64_t hashLines (const std::vector <std::string>& lines)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (auto& line : lines)
+  {
+    for (auto c : line)
+    {
+      hash ^= (unsigned char) c;
+      hash *= 1099511628211ULL;
+    }
+
+    hash ^= (unsigned char) '\n';
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void appendSnapshotString (std::string& buffer, const std::string& value)
+{
+  uint32_t length = value.length ();
+  buffer.append ((const char*) &length, sizeof (length));
+  buffer.append (value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void appendSnapshotRecord (std::string& buffer, const Task& task)
+{
+  uint32_t count = task.data.size ();
+  buffer.append ((const char*) &count, sizeof (count));
+
+  for (const auto& att : task.data)
+  {
+    appendSnapshotString (buffer, att.first);
+    appendSnapshotString (buffer, att.second);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool readSnapshotString (const char*& cursor, const char* end, std::string& value)
+{
+  uint32_t length;
+  if (end - cursor < (long) sizeof (length))
+    return false;
+
+  memcpy (&length, cursor, sizeof (length));
+  cursor += sizeof (length);
+
+  if (end - cursor < (long) length)
+    return false;
+
+  value.assign (cursor, length);
+  cursor += length;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Index files locate individual tasks in a data file, so that a task, or a
+// date range of tasks, can be read without loading the whole file:
+//
+//   header  magic[8] "TWINDEX\0"
+//           uint32   version
+//           uint32   entry count
+//           uint32   block count
+//           uint32   reserved
+//           uint64   source file size
+//           int64    source file mtime
+//   entry   char[36] uuid, uint64 offset, uint32 length    (sorted by uuid)
+//   block   uint64 offset, uint64 length,
+//           int64 min/max end, int64 min/max entry         (in file order)
+//
+// Like snapshots, an index that does not match the data file is not used, and
+// is rebuilt the next time the whole file is loaded.
+static const char     INDEX_MAGIC[8]   = {'T', 'W', 'I', 'N', 'D', 'E', 'X', 0};
+static const uint32_t INDEX_VERSION    = 1;
+static const size_t   INDEX_BLOCK_SIZE = 256;
+
+struct IndexHeader
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t count;
+  uint32_t blocks;
+  uint32_t reserved;
+  uint64_t size;
+  int64_t  mtime;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+static void widenRange (int64_t& low, int64_t& high, time_t value)
+{
+  // A missing date cannot be ruled out by any range.
+  if (value == 0)
+  {
+    low  = std::numeric_limits <int64_t>::min ();
+    high = std::numeric_limits <int64_t>::max ();
+  }
+  else
+  {
+    low  = std::min (low,  (int64_t) value);
+    high = std::max (high, (int64_t) value);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Adds the record at offset to the index being built.  Returns false if the
+// task cannot be indexed.
+static bool appendIndexRecord (
+  std::vector <TF2::IndexEntry>& entries,
+  std::vector <TF2::IndexBlock>& blocks,
+  uint64_t offset,
+  uint32_t length,
+  const Task& task)
+{
+  auto uuid = lowerCase (task.get ("uuid"));
+  if (uuid.length () != sizeof (TF2::IndexEntry::uuid))
+    return false;
+
+  TF2::IndexEntry entry;
+  memcpy (entry.uuid, uuid.data (), sizeof (entry.uuid));
+  entry.offset = offset;
+  entry.length = length;
+
+  if (entries.size () % INDEX_BLOCK_SIZE == 0)
+    blocks.push_back ({offset, 0,
+                       std::numeric_limits <int64_t>::max (), std::numeric_limits <int64_t>::min (),
+                       std::numeric_limits <int64_t>::max (), std::numeric_limits <int64_t>::min ()});
+
+  auto& block = blocks.back ();
+  block.length = offset + length + 1 - block.offset;
+  widenRange (block.min_end,   block.max_end,   task.get_date ("end"));
+  widenRange (block.min_entry, block.max_entry, task.get_date ("entry"));
+
+  entries.push_back (entry);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Journal files hold changes to a data file that have not yet been compacted
+// into it.  The first line identifies the data file state the journal was
+// started against, and each following line is a record:
+//
+//   base <size> <mtime>
+//   set <task>      Replaces the task with the same UUID, or appends it.
+//   del <uuid>      Removes the task.
+//
+// Records are keyed by UUID, so a journal still applies after another program
+// changes the data file, and is only removed once merged into it.  While a
+// journal is active, the data file itself is not modified.  Once the
+// journal outgrows both JOURNAL_MINIMUM and a JOURNAL_RATIO fraction of the
+// data file, GC or the next modification compacts both into a fresh data file.
+static const size_t JOURNAL_MINIMUM = 1 << 20;
+static const size_t JOURNAL_RATIO   = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+// Creates a file beside a data file, with the same permissions, whatever the
+// umask, so that a cache is no more readable than the data it holds.
+static FILE* createLike (const std::string& path, mode_t mode)
+{
+  int fd = open (path.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (fd == -1)
+    return nullptr;
+
+  fchmod (fd, mode & 07777);
+  auto fh = fdopen (fd, "wb");
+  if (! fh)
+    close (fd);
+
+  return fh;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Extracts the UUID from a task line, without parsing it.
+static std::string lineUUID (const std::string& line)
+{
+  for (auto& key : {"uuid:\"", "\"uuid\":\""})
+  {
+    auto length = strlen (key);
+    for (auto i = line.find (key); i != std::string::npos; i = line.find (key, i + 1))
+      if ((i == 0 || line[i - 1] == ' ' || line[i - 1] == '[' || line[i - 1] == '{' || line[i - 1] == ',') &&
+          i + length + 36 <= line.length ())
+        return line.substr (i + length, 36);
+  }
+
+  return "";
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 TF2::TF2 ()
 : _read_only (false)
@@ -93,6 +323,166 @@ const std::vector <std::string>& TF2::get_lines ()
   return _lines;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Reads only the tasks matching the given, possibly partial, UUIDs, in file
+// order.  Returns false if the index cannot be used, and the caller should
+// load the whole file instead.
+bool TF2::get_tasks (
+  const std::vector <std::string>& uuids,
+  std::vector <Task>& tasks)
+{
+  if (_loaded_tasks || ! use_index ())
+    return false;
+
+  if (_index_state == 0)
+    load_index ();
+
+  if (_index_state != 1)
+    return false;
+
+  Profiler::Scope scope ("load");
+  std::vector <const IndexEntry*> matches;
+  std::vector <Task> found;
+  for (auto& uuid : uuids)
+  {
+    if (uuid.length () > sizeof (IndexEntry::uuid))
+      continue;
+
+    // Tasks added but not yet written take precedence.
+    auto added = find_task (uuid);
+    if (added != -1)
+    {
+      found.push_back (_tasks[added]);
+      continue;
+    }
+
+    // The earliest record with the prefix is the match, as in a full scan.
+    auto prefix = lowerCase (uuid);
+    auto i = std::lower_bound (_index.begin (), _index.end (), prefix, [] (const IndexEntry& entry, const std::string& value)
+    {
+      return value.compare (0, value.length (), entry.uuid, value.length ()) > 0;
+    });
+
+    const IndexEntry* match = nullptr;
+    for (; i != _index.end () && ! prefix.compare (0, prefix.length (), i->uuid, prefix.length ()); ++i)
+      if (! match || i->offset < match->offset)
+        match = &*i;
+
+    if (match &&
+        _purged_tasks.find (std::string (match->uuid, sizeof (match->uuid))) == _purged_tasks.end ())
+      matches.push_back (match);
+  }
+
+  std::sort (matches.begin (), matches.end (), [] (const IndexEntry* left, const IndexEntry* right)
+  {
+    return left->offset < right->offset;
+  });
+  matches.erase (std::unique (matches.begin (), matches.end ()), matches.end ());
+
+  if (matches.size ())
+  {
+    auto fh = fopen (_file._data.c_str (), "r");
+    if (! fh)
+      return false;
+
+    std::vector <Task> records (matches.size ());
+    bool valid = true;
+    for (unsigned int m = 0; valid && m < matches.size (); ++m)
+      valid = read_record (fh, *matches[m], records[m]);
+
+    fclose (fh);
+
+    if (! valid)
+    {
+      _index_state = -1;
+      return false;
+    }
+
+    found.insert (found.begin (), records.begin (), records.end ());
+  }
+
+  tasks.insert (tasks.end (), found.begin (), found.end ());
+  Context::getContext ().debug (format ("TF2::get_tasks {1} of {2} tasks by UUID from {3}", (int) found.size (), (int) _index.size (), _file._data));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads only the blocks of tasks that may have the given date attribute in the
+// range [after, before].  The caller is expected to filter the tasks precisely.
+// Returns false if the index cannot be used.
+bool TF2::get_tasks (
+  const std::string& attribute,
+  int64_t after,
+  int64_t before,
+  std::vector <Task>& tasks)
+{
+  if (_loaded_tasks                              ||
+      (attribute != "end" && attribute != "entry") ||
+      ! use_index ())
+    return false;
+
+  if (_index_state == 0)
+    load_index ();
+
+  if (_index_state != 1)
+    return false;
+
+  Profiler::Scope scope ("load");
+  auto fh = fopen (_file._data.c_str (), "r");
+  if (! fh)
+    return false;
+
+  std::vector <Task> found;
+  std::string buffer;
+  int blocks = 0;
+  for (auto& block : _index_blocks)
+  {
+    auto low  = attribute == "end" ? block.min_end : block.min_entry;
+    auto high = attribute == "end" ? block.max_end : block.max_entry;
+    if (high < after || low > before)
+      continue;
+
+    buffer.resize (block.length);
+    if (fseek (fh, block.offset, SEEK_SET) != 0 ||
+        fread (&buffer[0], 1, block.length, fh) != block.length)
+    {
+      fclose (fh);
+      _index_state = -1;
+      return false;
+    }
+
+    try
+    {
+      for (auto& line : split (buffer, '\n'))
+      {
+        if (line.length ())
+        {
+          Task task (line);
+          if (_purged_tasks.find (task.get ("uuid")) == _purged_tasks.end ())
+            found.push_back (task);
+        }
+      }
+    }
+
+    catch (const std::string&)
+    {
+      fclose (fh);
+      _index_state = -1;
+      return false;
+    }
+
+    ++blocks;
+  }
+
+  fclose (fh);
+
+  // Tasks added but not yet written are always candidates.
+  tasks.insert (tasks.end (), found.begin (), found.end ());
+  tasks.insert (tasks.end (), _tasks.begin (), _tasks.end ());
+  Context::getContext ().debug (format ("TF2::get_tasks {1} of {2} blocks by {3} from {4}", blocks, (int) _index_blocks.size (), attribute, _file._data));
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Locate task by id.
 bool TF2::get (int id, Task& task)
@@ -100,6 +490,18 @@ bool TF2::get (int id, Task& task)
   if (! _loaded_tasks)
     load_tasks ();
 
+  // IDs map to UUIDs, which map to tasks.
+  auto uuid = _I2U.find (id);
+  if (uuid != _I2U.end ())
+  {
+    auto position = find_task (uuid->second);
+    if (position != -1 && _tasks[position].id == id)
+    {
+      task = _tasks[position];
+      return true;
+    }
+  }
+
   // This is an optimization.  Since the 'id' is based on the line number of
   // pending.data file, the task in question cannot appear earlier than line
   // (id - 1) in the file.  It can, however, appear significantly later because
@@ -121,29 +523,25 @@ bool TF2::get (int id, Task& task)
 bool TF2::get (const std::string& uuid, Task& task)
 {
   if (! _loaded_tasks)
-    load_tasks ();
-
-  if (_tasks_map.size () > 0 && uuid.size () == 36)
   {
-    // Fast lookup, same result as below. Only used during "task import".
-    auto i = _tasks_map.find (uuid);
-    if (i != _tasks_map.end ())
+    // Read only the matching record, if the index allows it.
+    std::vector <Task> found;
+    if (get_tasks (std::vector <std::string> {uuid}, found))
     {
-      task = i->second;
-      return true;
+      if (found.size ())
+        task = found[0];
+
+      return found.size () > 0;
     }
+
+    load_tasks ();
   }
-  else
+
+  auto position = find_task (uuid);
+  if (position != -1)
   {
-    // Slow lookup, same result as above.
-    for (auto& i : _tasks)
-    {
-      if (closeEnough (i.get ("uuid"), uuid, uuid.length ()))
-      {
-        task = i;
-        return true;
-      }
-    }
+    task = _tasks[position];
+    return true;
   }
 
   return false;
@@ -153,13 +551,16 @@ bool TF2::get (const std::string& uuid, Task& task)
 bool TF2::has (const std::string& uuid)
 {
   if (! _loaded_tasks)
-    load_tasks ();
+  {
+    std::vector <Task> found;
+    if (get_tasks (std::vector <std::string> {uuid}, found))
+      return found.size () && found[0].get ("uuid") == uuid;
 
-  for (auto& i : _tasks)
-    if (i.get ("uuid") == uuid)
-      return true;
+    load_tasks ();
+  }
 
-  return false;
+  auto position = find_task (uuid);
+  return position != -1 && _tasks[position].get ("uuid") == uuid;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -168,278 +569,1106 @@ void TF2::add_task (Task& task)
   _tasks.push_back (task);           // For subsequent queries
   _added_tasks.push_back (task);     // For commit/synch
 
-  // For faster lookup
-  if (Context::getContext ().cli2.getCommand () == "import")
-    _tasks_map.insert (std::pair<std::string, Task> (task.get("uuid"), task));
-
   Task::status status = task.getStatus ();
   if (task.id == 0 &&
       (status == Task::pending   ||
        status == Task::recurring ||
        status == Task::waiting))
   {
-    task.id = Context::getContext ().tdb2.next_id ();
+    task.id = Context::getContext ().tdb2.next_id ();
+  }
+
+  _I2U[task.id] = task.get ("uuid");
+  _U2I[task.get ("uuid")] = task.id;
+
+  _dirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool TF2::modify_task (const Task& task)
+{
+  // The file is rewritten on commit, so all of it is needed.
+  if (! _loaded_tasks)
+    load_tasks ();
+
+  std::string uuid = task.get ("uuid");
+
+  auto position = find_task (uuid);
+  if (position != -1 && _tasks[position].get ("uuid") == uuid)
+  {
+    // Modify in-place.
+    _tasks[position] = task;
+    _modified_tasks.push_back (task);
+    _dirty = true;
+    _graph_valid = false;
+
+    return true;
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool TF2::purge_task (const Task& task)
+{
+  // The file is rewritten on commit, so all of it is needed.
+  if (! _loaded_tasks)
+    load_tasks ();
+
+  // Bail out if task is not found in this file
+  std::string uuid = task.get ("uuid");
+  if (!has (uuid))
+    return false;
+
+  // Mark the task to be purged
+  _purged_tasks.insert (uuid);
+  _dirty = true;
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TF2::add_line (const std::string& line)
+{
+  _lines.push_back (line);
+  _added_lines.push_back (line);
+  _dirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TF2::clear_tasks ()
+{
+  _tasks.clear ();
+  _uuid_index.clear ();
+  _uuid_sorted.clear ();
+  _uuid_indexed = 0;
+  _graph_valid = false;
+  _dirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TF2::clear_lines ()
+{
+  _lines.clear ();
+  _dirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Discards the journal, for when the data file is rewritten directly.
+void TF2::clear_journal ()
+{
+  unlink (journal_file ().c_str ());
+  _journal_state = -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Has the next commit rewrite the file, if the journal is large enough to be
+// compacted.
+void TF2::compact_journal ()
+{
+  if (_loaded_tasks     &&
+      journal_active () &&
+      journal_large (0))
+  {
+    _compact = true;
+    _dirty = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Top-down recomposition.
+void TF2::commit ()
+{
+  // The _dirty flag indicates that the file needs to be written.
+  if (_dirty)
+  {
+    // Special case: added but no modified means just append to the file.
+    if (!_modified_tasks.size () && !_purged_tasks.size () &&
+        !_gc_records.size () && !_compact &&
+        (_added_tasks.size () || _added_lines.size ()))
+    {
+      // While there is a journal, the data file is left untouched.
+      if (! _added_lines.size () &&
+          journal_active ())
+      {
+        std::vector <std::string> records;
+        for (auto& task : _added_tasks)
+          records.push_back ("set " + task.composeF4 ());
+
+        if (write_journal (records))
+        {
+          _added_tasks.clear ();
+          _dirty = false;
+        }
+      }
+
+      else if (open_locked ())
+      {
+        // Write out all the added tasks.
+        _file.append (std::string(""));  // Seek to end of file
+        for (auto& task : _added_tasks)
+          _file.write_raw (task.composeF4 () + "\n");
+
+        _added_tasks.clear ();
+
+        // Write out all the added lines.
+        _file.append (_added_lines);
+
+        _added_lines.clear ();
+        _file.close ();
+        _dirty = false;
+        _index_state = 0;
+      }
+    }
+    else
+    {
+      // Journal just the changes, if possible.
+      std::vector <std::string> journal;
+      if (journal_changes (journal) &&
+          write_journal (journal))
+      {
+        _gc_records.clear ();
+        _dirty = false;
+      }
+
+      else if (open_locked ())
+      {
+        // Write a fresh file, and rename it over the old one, so that a failure
+        // part way through leaves the old file intact.
+        auto temporary = _file._data + ".tmp";
+        auto fh = fopen (temporary.c_str (), "w");
+        if (! fh)
+        {
+          _file.close ();
+          throw format ("Could not write to '{1}'.", temporary);
+        }
+
+        // Only write out _tasks, because any deltas have already been applied.
+        // The lines written are retained, so the snapshot can be rebuilt.
+        bool snapshot = Context::getContext ().config.getBoolean ("snapshot") &&
+                        ! _added_lines.size ();
+        std::vector <std::string> written;
+        std::string records;
+        uint32_t count = 0;
+
+        // The index is rebuilt from the record offsets.
+        bool index = ! _added_lines.size () && use_index ();
+        std::vector <IndexEntry> entries;
+        std::vector <IndexBlock> blocks;
+        uint64_t offset = 0;
+
+        bool ok = true;
+        for (auto& task : _tasks)
+        {
+          // Skip over the tasks that are marked to be purged
+          if (_purged_tasks.find (task.get ("uuid")) == _purged_tasks.end ())
+          {
+            auto line = task.composeF4 () + '\n';
+            ok = ok && fwrite (line.data (), line.length (), 1, fh) == 1;
+            line.pop_back ();
+
+            if (snapshot)
+            {
+              written.push_back (line);
+              appendSnapshotRecord (records, task);
+              ++count;
+            }
+
+            if (index &&
+                ! appendIndexRecord (entries, blocks, offset, line.length (), task))
+              index = false;
+
+            offset += line.length () + 1;
+          }
+        }
+
+        // Write out all the added lines.
+        for (auto& line : _added_lines)
+          ok = ok && fwrite (line.data (), line.length (), 1, fh) == 1;
+
+        ok = fflush (fh) == 0 && fsync (fileno (fh)) == 0 && ok;
+        fchmod (fileno (fh), _file.mode () & 07777);
+        ok = fclose (fh) == 0 && ok;
+
+        if (! ok || rename (temporary.c_str (), _file._data.c_str ()) != 0)
+        {
+          unlink (temporary.c_str ());
+          _file.close ();
+          throw format ("Could not write to '{1}'.", _file._data);
+        }
+
+        // The journal is now part of the file.
+        clear_journal ();
+        _gc_records.clear ();
+        _compact = false;
+
+        // The caches are written while the file is still locked.
+        if (snapshot)
+          save_snapshot (hashLines (written), records, count);
+
+        if (index)
+          save_index (entries, blocks);
+
+        _added_lines.clear ();
+        _file.close ();
+        _dirty = false;
+        _index_state = 0;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Load a single Task object, handle necessary plumbing work
+Task TF2::load_task (const std::string& line)
+{
+  Task task (line);
+  load_id (task);
+  return task;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Assign an ID, if the task qualifies, and record the mapping.
+void TF2::load_id (Task& task)
+{
+  // Some tasks get an ID.
+  if (_has_ids)
+  {
+    Task::status status = task.getStatus ();
+    // Completed / deleted tasks in pending.data get an ID if GC is off.
+    if (! Context::getContext ().run_gc ||
+        (status != Task::completed && status != Task::deleted))
+      task.id = Context::getContext ().tdb2.next_id ();
+  }
+
+  // Maintain mapping for ease of link/dependency resolution.
+  // Note that this mapping is not restricted by the filter, and is
+  // therefore a complete set.
+  if (task.id)
+  {
+    _I2U[task.id] = task.get ("uuid");
+    _U2I[task.get ("uuid")] = task.id;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Check whether task needs to be relocated to pending/completed,
+// or needs to be 'woken'.
+void TF2::load_gc (Task& task)
+{
+  Datetime now;
+  auto& tdb2 = Context::getContext ().tdb2;
+  TF2* destination = &tdb2.completed;
+  bool woken = false;
+
+  std::string status = task.get ("status");
+  if (status == "pending" ||
+      status == "recurring")
+  {
+    destination = &tdb2.pending;
+  }
+  else if (status == "waiting")
+  {
+    Datetime wait (task.get_date ("wait"));
+    if (wait < now)
+    {
+      task.set ("status", "pending");
+      task.remove ("wait");
+      // Unwaiting pending tasks is the only case not caught by the size()
+      // checks in TDB2::gc(), so we need to signal it here.
+      tdb2.pending._dirty = true;
+      woken = true;
+
+      if (Context::getContext ().verbose ("unwait"))
+        Context::getContext ().footnote (format ("Un-waiting task {1} '{2}'", task.id, task.get ("description")));
+    }
+
+    destination = &tdb2.pending;
+  }
+
+  // The journal records what GC changed, as the task lists do not.
+  if ((destination != this || woken) &&
+      Context::getContext ().config.getBoolean ("data.journal"))
+  {
+    if (destination != this)
+      _gc_records.push_back ("del " + task.get ("uuid"));
+
+    destination->_gc_records.push_back ("set " + task.composeF4 ());
+  }
+
+  destination->_tasks.push_back (task);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TF2::load_tasks (bool from_gc /* = false */)
+{
+  Profiler::Scope scope ("load");
+
+  if (! _loaded_lines)
+  {
+    load_lines ();
+
+    // Apply previously added lines.
+    for (auto& line : _added_lines)
+      _lines.push_back (line);
+  }
+
+  // Reduce unnecessary allocations/copies.
+  // Calling it on _tasks is the right thing to do even when from_gc is set.
+  _tasks.reserve (_lines.size ());
+
+  // A snapshot describes the file contents, so unwritten lines rule it out.
+  bool snapshot = _lines.size () &&
+                  ! _added_lines.size () &&
+                  Context::getContext ().config.getBoolean ("snapshot");
+
+  // Tasks parsed by preload are used in the same way as a snapshot.
+  bool preloaded = _preloaded.size () &&
+                   _preloaded.size () == _lines.size () &&
+                   ! _added_lines.size ();
+
+  uint64_t hash = snapshot && ! preloaded ? hashLines (_lines) : 0;
+  std::vector <Task> parsed;
+  if (preloaded)
+    parsed.swap (_preloaded);
+
+  bool cached = preloaded                      ||
+                (snapshot                      &&
+                 load_snapshot (hash, parsed)  &&
+                 parsed.size () == _lines.size ());
+
+  // Composed snapshot records, if the snapshot needs to be rebuilt.
+  std::string records;
+
+  // The index is rebuilt alongside a full load, if it is missing or stale.
+  bool index = _lines.size ()         &&
+               ! _added_lines.size () &&
+               use_index ()           &&
+               ! load_index (true);
+  std::vector <IndexEntry> entries;
+  std::vector <IndexBlock> blocks;
+  uint64_t offset = 0;
+
+  int line_number = 0;  // Used for error message in catch block.
+  try
+  {
+    if (cached)
+    {
+      for (auto& task : parsed)
+      {
+        auto length = _lines[line_number].length ();
+        if (index &&
+            ! appendIndexRecord (entries, blocks, offset, length, task))
+          index = false;
+
+        offset += length + 1;
+        ++line_number;
+        load_id (task);
+
+        if (from_gc)
+          load_gc (task);
+        else
+          _tasks.push_back (task);
+      }
+    }
+    else
+    {
+      std::vector <Task> ready;
+      std::vector <char> done;
+      parse_lines (ready, done);
+
+      for (auto& line : _lines)
+      {
+        // Lines not parsed ahead are parsed here, which also reports errors.
+        ++line_number;
+        Task task;
+        if (done.size () && done[line_number - 1])
+        {
+          task = std::move (ready[line_number - 1]);
+          load_id (task);
+        }
+        else
+          task = load_task (line);
+
+        // Capture the task as parsed, before GC has a chance to modify it.
+        if (snapshot)
+          appendSnapshotRecord (records, task);
+
+        if (index &&
+            ! appendIndexRecord (entries, blocks, offset, line.length (), task))
+          index = false;
+
+        offset += line.length () + 1;
+
+        if (from_gc)
+          load_gc (task);
+        else
+          _tasks.push_back (std::move (task));
+      }
+    }
+
+    // TDB2::gc() calls this after loading both pending and completed
+    if (_auto_dep_scan && !from_gc)
+      dependency_scan ();
+
+    _loaded_tasks = true;
+  }
+
+  catch (const std::string& e)
+  {
+    throw e + format (" in {1} at line {2}", _file._data, line_number);
+  }
+
+  Context::getContext ().profiler.count (preloaded ? "tasks.preloaded" : cached ? "tasks.snapshot" : "tasks.parsed", line_number);
+
+  // The caches are written under the lock, and only if the file is still as
+  // it was read.
+  if (((snapshot && ! cached) || index) &&
+      open_locked ())
+  {
+    if (journal_header () == _read_state)
+    {
+      if (snapshot && ! cached)
+        save_snapshot (hash, records, line_number);
+
+      if (index)
+        save_index (entries, blocks);
+    }
+
+    _file.close ();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Parses large files ahead of load_tasks, on several threads, with each thread
+// taking a contiguous range of lines.  Only well-formed FF4 lines are parsed
+// here, and marked done.  The rest, including anything that fails, are left to
+// the serial pass, so that IDs, legacy formats and errors are handled in
+// order, as before.
+void TF2::parse_lines (std::vector <Task>& tasks, std::vector <char>& done) const
+{
+  auto count = _lines.size ();
+  size_t threads = std::max ((size_t) 1, std::min ((size_t) std::thread::hardware_concurrency (), count / LOAD_CHUNK));
+  if (threads == 1)
+    return;
+
+  tasks.resize (count);
+  done.assign (count, 0);
+
+  std::vector <std::thread> pool;
+  auto chunk = (count + threads - 1) / threads;
+  for (size_t t = 0; t < threads; ++t)
+  {
+    pool.emplace_back ([&, t] ()
+    {
+      auto end = std::min (count, (t + 1) * chunk);
+      for (auto i = t * chunk; i < end; ++i)
+      {
+        if (_lines[i].length () == 0 ||
+            _lines[i][0] != '[')
+          continue;
+
+        try
+        {
+          tasks[i].parseF4 (_lines[i]);
+          done[i] = tasks[i].data.size () ? 1 : 0;
+        }
+
+        catch (...)
+        {
+          tasks[i] = Task ();
+        }
+      }
+    });
+  }
+
+  for (auto& thread : pool)
+    thread.join ();
+
+  Context::getContext ().debug (format ("TF2::load_tasks parsed {1} lines on {2} threads", count, threads));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Opens the file, locked if configured.  A commit renames a fresh file over the
+// path, so a process that was waiting for the lock may hold it on the old file,
+// which is then reopened until the locked file is the one at the path.
+bool TF2::open_locked ()
+{
+  while (_file.open ())
+  {
+    if (! Context::getContext ().config.getBoolean ("locking"))
+      return true;
+
+    _file.lock ();
+
+    struct stat path;
+    struct stat locked;
+    if (stat (_file._data.c_str (), &path) != 0 ||
+        fstat (_file._h, &locked) != 0        ||
+        (path.st_dev == locked.st_dev &&
+         path.st_ino == locked.st_ino))
+      return true;
+
+    _file.close ();
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TF2::load_lines ()
+{
+  if (open_locked ())
+  {
+    _file.read (_lines);
+    _read_state = journal_header ();
+    Context::getContext ().profiler.count ("bytes.read", (long) _file.size ());
+    replay_journal ();
+    _file.close ();
+    _loaded_lines = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reads and parses the file ahead of load_tasks, for the daemon.  IDs are
+// assigned later, by load_tasks, because they depend on whether the command
+// runs GC.  A file that does not parse cleanly is left to load_tasks, which
+// reports the error.
+void TF2::preload ()
+{
+  if (! _loaded_lines)
+    load_lines ();
+
+  std::vector <Task> ready;
+  std::vector <char> done;
+  parse_lines (ready, done);
+
+  std::vector <Task> tasks;
+  tasks.reserve (_lines.size ());
+
+  try
+  {
+    for (size_t i = 0; i < _lines.size (); ++i)
+      if (done.size () && done[i])
+        tasks.push_back (std::move (ready[i]));
+      else
+        tasks.push_back (Task (_lines[i]));
+  }
+
+  catch (const std::string&)
+  {
+    return;
+  }
+
+  _preloaded = std::move (tasks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::string TF2::journal_file () const
+{
+  return _file._data + ".journal";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::string TF2::journal_header () const
+{
+  return "base " + std::to_string (_file.size ()) + ' ' + std::to_string (_file.mtime ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A journal is active once it has a header, whether or not the data file has
+// changed since.  The answer is kept until the journal is next read, written
+// or removed.
+bool TF2::journal_active ()
+{
+  if (_journal_state == 0)
+  {
+    std::ifstream in (journal_file ());
+    std::string header;
+    _journal_state = in.good ()                &&
+                     std::getline (in, header) &&
+                     ! header.compare (0, 5, "base ") ? 1 : -1;
+  }
+
+  return _journal_state == 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether the journal, with bytes more, is due to be compacted.
+bool TF2::journal_large (size_t bytes) const
+{
+  struct stat s;
+  if (stat (journal_file ().c_str (), &s) == 0)
+    bytes += s.st_size;
+
+  return bytes >= JOURNAL_MINIMUM &&
+         bytes >= _file.size () / JOURNAL_RATIO;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Applies the journal records to _lines.  A data file changed by another
+// program since the journal was started still gets the records, by UUID.
+void TF2::replay_journal ()
+{
+  std::vector <std::string> records;
+  if (! File::read (journal_file (), records) ||
+      ! records.size ())
+  {
+    _journal_state = -1;
+    return;
+  }
+
+  if (records[0].compare (0, 5, "base "))
+    throw format ("The journal '{1}' is damaged, and has not been applied.", journal_file ());
+
+  _journal_state = 1;
+
+  if (records[0] != journal_header ())
+    Context::getContext ().debug (format ("TF2::replay_journal {1} changed since the journal was started", _file._data));
+
+  std::unordered_map <std::string, size_t> positions;
+  for (size_t i = 0; i < _lines.size (); ++i)
+    positions.emplace (lineUUID (_lines[i]), i);
+
+  std::vector <bool> removed (_lines.size (), false);
+  for (size_t r = 1; r < records.size (); ++r)
+  {
+    auto& record = records[r];
+
+    // A record cut short by a crash is ignored.
+    if (! record.compare (0, 4, "set ") &&
+        record.back () == ']')
+    {
+      auto line = record.substr (4);
+      auto uuid = lineUUID (line);
+      auto i = positions.find (uuid);
+      if (i != positions.end ())
+        _lines[i->second] = line;
+      else
+      {
+        positions[uuid] = _lines.size ();
+        _lines.push_back (line);
+        removed.push_back (false);
+      }
+    }
+    else if (! record.compare (0, 4, "del ") &&
+             record.length () == 40)
+    {
+      auto i = positions.find (record.substr (4));
+      if (i != positions.end ())
+      {
+        removed[i->second] = true;
+        positions.erase (i);
+      }
+    }
+  }
+
+  size_t kept = 0;
+  for (size_t i = 0; i < _lines.size (); ++i)
+    if (! removed[i])
+      _lines[kept++] = _lines[i];
+
+  _lines.resize (kept);
+  Context::getContext ().debug (format ("TF2::replay_journal {1} records from {2}", (int) records.size () - 1, journal_file ()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Determines the journal records for the changes made since the file was
+// loaded: the moves made by GC, then the last version of each added or
+// modified task, then the purged tasks.  Returns false if the file should be
+// rewritten instead.
+bool TF2::journal_changes (std::vector <std::string>& records)
+{
+  if (! Context::getContext ().config.getBoolean ("data.journal") ||
+      ! _loaded_tasks                                             ||
+      _added_lines.size ()                                        ||
+      _read_only                                                  ||
+      _compact)
+    return false;
+
+  records = _gc_records;
+
+  std::unordered_set <std::string> recorded;
+  for (auto changes : {&_modified_tasks, &_added_tasks})
+  {
+    for (auto task = changes->rbegin (); task != changes->rend (); ++task)
+    {
+      auto uuid = task->get ("uuid");
+      if (_purged_tasks.find (uuid) == _purged_tasks.end () &&
+          recorded.insert (uuid).second)
+        records.push_back ("set " + task->composeF4 ());
+    }
+  }
+
+  for (auto& uuid : _purged_tasks)
+    records.push_back ("del " + uuid);
+
+  size_t bytes = 0;
+  for (auto& record : records)
+    bytes += record.length () + 1;
+
+  // Compact, once the journal is large.
+  return ! journal_large (bytes);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Appends records to the journal, starting a new one if necessary.  The data
+// file is locked throughout, as for any other write.
+bool TF2::write_journal (const std::vector <std::string>& records)
+{
+  if (! records.size ())
+    return true;
+
+  if (! open_locked ())
+    return false;
+
+  // Another process may have started or compacted the journal meanwhile.  A
+  // journal without a header is never overwritten, as it may hold changes.
+  _journal_state = 0;
+  bool active = journal_active ();
+  struct stat s;
+  if (! active &&
+      stat (journal_file ().c_str (), &s) == 0 &&
+      s.st_size > 0)
+  {
+    _file.close ();
+    throw format ("The journal '{1}' is damaged, and has not been applied.", journal_file ());
+  }
+
+  auto fh = fopen (journal_file ().c_str (), active ? "a" : "w");
+  bool ok = fh != nullptr;
+  if (ok && ! active)
+  {
+    auto header = journal_header () + '\n';
+    ok = fwrite (header.data (), header.length (), 1, fh) == 1;
+  }
+
+  for (auto& record : records)
+  {
+    auto line = record + '\n';
+    ok = ok && fwrite (line.data (), line.length (), 1, fh) == 1;
+  }
+
+  if (fh)
+  {
+    ok = fflush (fh) == 0 && fsync (fileno (fh)) == 0 && ok;
+    ok = fclose (fh) == 0 && ok;
+  }
+
+  _file.close ();
+
+  if (! ok)
+  {
+    _journal_state = 0;
+    throw format ("Could not write to '{1}'.", journal_file ());
   }
 
-  _I2U[task.id] = task.get ("uuid");
-  _U2I[task.get ("uuid")] = task.id;
+  _journal_state = 1;
 
-  _dirty = true;
+  Context::getContext ().debug (format ("TF2::write_journal {1} records to {2}", (int) records.size (), journal_file ()));
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-bool TF2::modify_task (const Task& task)
+const std::string TF2::snapshot_file () const
 {
-  std::string uuid = task.get ("uuid");
+  return _file._data + ".snapshot";
+}
 
-  if (Context::getContext ().cli2.getCommand () == "import")
+////////////////////////////////////////////////////////////////////////////////
+// Maps the snapshot file and, if it matches the data file, decodes every task
+// in it.  Any mismatch or corruption simply means the snapshot is not used.
+bool TF2::load_snapshot (uint64_t hash, std::vector <Task>& tasks)
+{
+  auto fd = open (snapshot_file ().c_str (), O_RDONLY);
+  if (fd == -1)
+    return false;
+
+  struct stat s;
+  if (fstat (fd, &s) != 0 ||
+      s.st_size < (off_t) sizeof (SnapshotHeader))
   {
-    // Update map used for faster lookup
-    auto i = _tasks_map.find (uuid);
-    if (i != _tasks_map.end ())
-    {
-      i->second = task;
-    }
+    close (fd);
+    return false;
   }
 
-  for (auto& i : _tasks)
+  auto map = mmap (nullptr, s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    return false;
+
+  const char* cursor = (const char*) map;
+  const char* end    = cursor + s.st_size;
+
+  SnapshotHeader header;
+  memcpy (&header, cursor, sizeof (header));
+  cursor += sizeof (header);
+
+  bool valid = ! memcmp (header.magic, SNAPSHOT_MAGIC, sizeof (SNAPSHOT_MAGIC)) &&
+               header.version == SNAPSHOT_VERSION                               &&
+               header.size    == (uint64_t) _file.size ()                       &&
+               header.mtime   == (int64_t) _file.mtime ()                       &&
+               header.hash    == hash;
+
+  if (valid)
   {
-    if (i.get ("uuid") == uuid)
+    tasks.reserve (header.count);
+    std::string name;
+    std::string value;
+    for (uint32_t t = 0; valid && t < header.count; ++t)
     {
-      // Modify in-place.
-      i = task;
-      _modified_tasks.push_back (task);
-      _dirty = true;
+      uint32_t count;
+      if (end - cursor < (long) sizeof (count))
+      {
+        valid = false;
+        break;
+      }
 
-      return true;
+      memcpy (&count, cursor, sizeof (count));
+      cursor += sizeof (count);
+
+      Task task;
+      for (uint32_t a = 0; a < count; ++a)
+      {
+        if (! readSnapshotString (cursor, end, name) ||
+            ! readSnapshotString (cursor, end, value))
+        {
+          valid = false;
+          break;
+        }
+
+        if (! name.compare (0, 11, "annotation_", 11))
+          ++task.annotation_count;
+
+        task.data[name] = value;
+      }
+
+      tasks.push_back (task);
     }
   }
 
-  return false;
-}
+  munmap (map, s.st_size);
 
-////////////////////////////////////////////////////////////////////////////////
-bool TF2::purge_task (const Task& task)
-{
-  // Bail out if task is not found in this file
-  std::string uuid = task.get ("uuid");
-  if (!has (uuid))
+  if (! valid)
+  {
+    tasks.clear ();
     return false;
+  }
 
-  // Mark the task to be purged
-  _purged_tasks.insert (uuid);
-  _dirty = true;
-
+  Context::getContext ().debug (format ("TF2::load_snapshot {1} tasks from {2}", (int) tasks.size (), snapshot_file ()));
   return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void TF2::add_line (const std::string& line)
+// Writes the snapshot to a temporary file first, then renames it into place, so
+// that a concurrent reader never sees a partial snapshot.  Failure is silent,
+// because the data file is the authority, and a missing snapshot is only slow.
+void TF2::save_snapshot (uint64_t hash, const std::string& records, uint32_t count)
 {
-  _lines.push_back (line);
-  _added_lines.push_back (line);
-  _dirty = true;
+  if (_read_only || ! _file.exists ())
+    return;
+
+  SnapshotHeader header;
+  memcpy (header.magic, SNAPSHOT_MAGIC, sizeof (SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.count   = count;
+  header.size    = _file.size ();
+  header.mtime   = _file.mtime ();
+  header.hash    = hash;
+
+  auto temporary = snapshot_file () + ".tmp";
+  auto fh = createLike (temporary, _file.mode ());
+  if (! fh)
+    return;
+
+  bool ok = fwrite (&header, sizeof (header), 1, fh) == 1 &&
+            (records.length () == 0 || fwrite (records.data (), records.length (), 1, fh) == 1);
+
+  if (fclose (fh) == 0 && ok && rename (temporary.c_str (), snapshot_file ().c_str ()) == 0)
+    return;
+
+  unlink (temporary.c_str ());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void TF2::clear_tasks ()
+const std::string TF2::index_file () const
 {
-  _tasks.clear ();
-  _dirty = true;
+  return _file._data + ".index";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void TF2::clear_lines ()
+// Only files without IDs are indexed, because IDs depend on a full load, and
+// only without a journal, because the index describes the file alone.
+bool TF2::use_index ()
 {
-  _lines.clear ();
-  _dirty = true;
+  return ! _has_ids                                       &&
+         Context::getContext ().config.getBoolean ("index") &&
+         ! journal_active ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Top-down recomposition.
-void TF2::commit ()
+// Reads the index, if it matches the data file.  With header_only, this just
+// determines whether there is a current index.
+bool TF2::load_index (bool header_only /* = false */)
 {
-  // The _dirty flag indicates that the file needs to be written.
-  if (_dirty)
+  auto fh = fopen (index_file ().c_str (), "rb");
+  if (! fh)
   {
-    // Special case: added but no modified means just append to the file.
-    if (!_modified_tasks.size () && !_purged_tasks.size () &&
-        (_added_tasks.size () || _added_lines.size ()))
-    {
-      if (_file.open ())
-      {
-        if (Context::getContext ().config.getBoolean ("locking"))
-          _file.lock ();
+    if (! header_only)
+      _index_state = -1;
 
-        // Write out all the added tasks.
-        _file.append (std::string(""));  // Seek to end of file
-        for (auto& task : _added_tasks)
-          _file.write_raw (task.composeF4 () + "\n");
+    return false;
+  }
 
-        _added_tasks.clear ();
+  IndexHeader header;
+  bool valid = fread (&header, sizeof (header), 1, fh) == 1                       &&
+               ! memcmp (header.magic, INDEX_MAGIC, sizeof (INDEX_MAGIC))         &&
+               header.version == INDEX_VERSION                                    &&
+               _file.exists ()                                                    &&
+               header.size    == (uint64_t) _file.size ()                         &&
+               header.mtime   == (int64_t) _file.mtime ();
 
-        // Write out all the added lines.
-        _file.append (_added_lines);
+  if (valid && ! header_only)
+  {
+    _index.resize (header.count);
+    _index_blocks.resize (header.blocks);
+    valid = (! header.count  || fread (&_index[0],        sizeof (IndexEntry), header.count,  fh) == header.count) &&
+            (! header.blocks || fread (&_index_blocks[0], sizeof (IndexBlock), header.blocks, fh) == header.blocks);
 
-        _added_lines.clear ();
-        _file.close ();
-        _dirty = false;
-      }
-    }
-    else
+    if (! valid)
     {
-      if (_file.open ())
-      {
-        if (Context::getContext ().config.getBoolean ("locking"))
-          _file.lock ();
+      _index.clear ();
+      _index_blocks.clear ();
+    }
 
-        // Truncate the file and rewrite.
-        _file.truncate ();
+    _index_state = valid ? 1 : -1;
+  }
 
-        // Only write out _tasks, because any deltas have already been applied.
-        _file.append (std::string(""));  // Seek to end of file
-        for (auto& task : _tasks)
-          // Skip over the tasks that are marked to be purged
-          if (_purged_tasks.find (task.get ("uuid")) == _purged_tasks.end ())
-            _file.write_raw (task.composeF4 () + '\n');
+  fclose (fh);
+  return valid;
+}
 
-        // Write out all the added lines.
-        _file.append (_added_lines);
+////////////////////////////////////////////////////////////////////////////////
+// Same atomic, silent write as for snapshots.
+void TF2::save_index (
+  std::vector <IndexEntry>& entries,
+  const std::vector <IndexBlock>& blocks)
+{
+  if (_read_only || ! _file.exists ())
+    return;
 
-        _added_lines.clear ();
-        _file.close ();
-        _dirty = false;
-      }
-    }
-  }
+  std::sort (entries.begin (), entries.end (), [] (const IndexEntry& left, const IndexEntry& right)
+  {
+    return memcmp (left.uuid, right.uuid, sizeof (left.uuid)) < 0;
+  });
+
+  IndexHeader header;
+  memcpy (header.magic, INDEX_MAGIC, sizeof (INDEX_MAGIC));
+  header.version  = INDEX_VERSION;
+  header.count    = entries.size ();
+  header.blocks   = blocks.size ();
+  header.reserved = 0;
+  header.size     = _file.size ();
+  header.mtime    = _file.mtime ();
+
+  auto temporary = index_file () + ".tmp";
+  auto fh = createLike (temporary, _file.mode ());
+  if (! fh)
+    return;
+
+  bool ok = fwrite (&header, sizeof (header), 1, fh) == 1                                                  &&
+            (! entries.size () || fwrite (&entries[0], sizeof (IndexEntry), entries.size (), fh) == entries.size ()) &&
+            (! blocks.size ()  || fwrite (&blocks[0],  sizeof (IndexBlock), blocks.size (),  fh) == blocks.size ());
+
+  if (fclose (fh) == 0 && ok && rename (temporary.c_str (), index_file ().c_str ()) == 0)
+    return;
+
+  unlink (temporary.c_str ());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Load a single Task object, handle necessary plumbing work
-Task TF2::load_task (const std::string& line)
+// Reads and parses a single record, and verifies that it is the expected task.
+bool TF2::read_record (FILE* fh, const IndexEntry& entry, Task& task)
 {
-  Task task (line);
+  std::string line (entry.length, '\0');
+  if (fseek (fh, entry.offset, SEEK_SET) != 0 ||
+      (entry.length && fread (&line[0], 1, entry.length, fh) != entry.length))
+    return false;
 
-  // Some tasks get an ID.
-  if (_has_ids)
+  try
   {
-    Task::status status = task.getStatus ();
-    // Completed / deleted tasks in pending.data get an ID if GC is off.
-    if (! Context::getContext ().run_gc ||
-        (status != Task::completed && status != Task::deleted))
-      task.id = Context::getContext ().tdb2.next_id ();
+    task = Task (line);
   }
 
-  // Maintain mapping for ease of link/dependency resolution.
-  // Note that this mapping is not restricted by the filter, and is
-  // therefore a complete set.
-  if (task.id)
+  catch (const std::string&)
   {
-    _I2U[task.id] = task.get ("uuid");
-    _U2I[task.get ("uuid")] = task.id;
+    return false;
   }
 
-  return task;
+  return lowerCase (task.get ("uuid")) == std::string (entry.uuid, sizeof (entry.uuid));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// Check whether task needs to be relocated to pending/completed,
-// or needs to be 'woken'.
-void TF2::load_gc (Task& task)
+// Extends the UUID index to cover any tasks appended to _tasks since the last
+// call.  Tasks are only ever appended, modified in place or cleared.
+void TF2::index_tasks ()
 {
-  Datetime now;
-
-  std::string status = task.get ("status");
-  if (status == "pending" ||
-      status == "recurring")
+  if (_uuid_indexed > _tasks.size ())
   {
-    Context::getContext ().tdb2.pending._tasks.push_back (task);
+    _uuid_index.clear ();
+    _uuid_indexed = 0;
   }
-  else if (status == "waiting")
-  {
-    Datetime wait (task.get_date ("wait"));
-    if (wait < now)
-    {
-      task.set ("status", "pending");
-      task.remove ("wait");
-      // Unwaiting pending tasks is the only case not caught by the size()
-      // checks in TDB2::gc(), so we need to signal it here.
-      Context::getContext ().tdb2.pending._dirty = true;
 
-      if (Context::getContext ().verbose ("unwait"))
-        Context::getContext ().footnote (format ("Un-waiting task {1} '{2}'", task.id, task.get ("description")));
-    }
+  if (_uuid_indexed < _tasks.size ())
+    _uuid_sorted.clear ();
 
-    Context::getContext ().tdb2.pending._tasks.push_back (task);
-  }
-  else
-  {
-    Context::getContext ().tdb2.completed._tasks.push_back (task);
-  }
+  // The first occurrence of a UUID wins, as it would in a scan.
+  for (; _uuid_indexed < _tasks.size (); ++_uuid_indexed)
+    _uuid_index.emplace (lowerCase (_tasks[_uuid_indexed].get ("uuid")), _uuid_indexed);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void TF2::load_tasks (bool from_gc /* = false */)
+// Returns the position in _tasks of the first task matching the, possibly
+// partial, UUID, or -1.
+long TF2::find_task (const std::string& uuid)
 {
-  Timer timer;
-
-  if (! _loaded_lines)
-  {
-    load_lines ();
+  index_tasks ();
 
-    // Apply previously added lines.
-    for (auto& line : _added_lines)
-      _lines.push_back (line);
-  }
+  auto key = lowerCase (uuid);
+  auto exact = _uuid_index.find (key);
+  if (exact != _uuid_index.end ())
+    return exact->second;
 
-  // Reduce unnecessary allocations/copies.
-  // Calling it on _tasks is the right thing to do even when from_gc is set.
-  _tasks.reserve (_lines.size ());
+  if (key.length () >= 36)
+    return -1;
 
-  int line_number = 0;  // Used for error message in catch block.
-  try
+  if (_uuid_sorted.empty ())
   {
-    for (auto& line : _lines)
-    {
-      ++line_number;
-      auto task = load_task (line);
-
-      if (from_gc)
-        load_gc (task);
-      else
-        _tasks.push_back (task);
-
-      if (Context::getContext ().cli2.getCommand () == "import")  // For faster lookup only
-        _tasks_map.insert (std::pair<std::string, Task> (task.get("uuid"), task));
-    }
-
-    // TDB2::gc() calls this after loading both pending and completed
-    if (_auto_dep_scan && !from_gc)
-      dependency_scan ();
-
-    _loaded_tasks = true;
+    _uuid_sorted.assign (_uuid_index.begin (), _uuid_index.end ());
+    std::sort (_uuid_sorted.begin (), _uuid_sorted.end ());
   }
 
-  catch (const std::string& e)
-  {
-    throw e + format (" in {1} at line {2}", _file._data, line_number);
-  }
+  // All UUIDs with the prefix are adjacent, and the earliest task wins.
+  long position = -1;
+  for (auto i = std::lower_bound (_uuid_sorted.begin (), _uuid_sorted.end (), std::pair <std::string, size_t> (key, 0));
+       i != _uuid_sorted.end () && ! i->first.compare (0, key.length (), key);
+       ++i)
+    if (position == -1 || (long) i->second < position)
+      position = i->second;
 
-  Context::getContext ().time_load_us += timer.total_us ();
+  return position;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-void TF2::load_lines ()
+// Returns the position in _tasks of the first task with exactly this UUID, or
+// -1.
+long TF2::find_exact (const std::string& uuid)
 {
-  if (_file.open ())
-  {
-    if (Context::getContext ().config.getBoolean ("locking"))
-      _file.lock ();
+  auto position = find_task (uuid);
+  if (position != -1 && _tasks[position].get ("uuid") != uuid)
+    return -1;
 
-    _file.read (_lines);
-    _file.close ();
-    _loaded_lines = true;
-  }
+  return position;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -512,8 +1741,16 @@ void TF2::clear ()
   _purged_tasks.clear ();
   _lines.clear ();
   _added_lines.clear ();
+  _preloaded.clear ();
+  _journal_state = 0;
+  _gc_records.clear ();
+  _compact = false;
   _I2U.clear ();
   _U2I.clear ();
+  _uuid_index.clear ();
+  _uuid_sorted.clear ();
+  _uuid_indexed = 0;
+  _graph_valid = false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -522,38 +1759,135 @@ void TF2::clear ()
 // cache.
 void TF2::dependency_scan ()
 {
+  dependency_graph ();
+
   // Iterate and modify TDB2 in-place.  Don't do this at home.
-  for (auto& left : _tasks)
+  for (size_t i = 0; i < _tasks.size (); ++i)
   {
-    if (left.has ("depends"))
+    auto& left = _tasks[i];
+    for (auto& dep : _depends[i])
     {
-      for (auto& dep : left.getDependencyUUIDs ())
+      auto position = find_exact (dep);
+      if (position != -1)
       {
-        for (auto& right : _tasks)
+        auto& right = _tasks[position];
+
+        // GC hasn't run yet, check both tasks for their current status
+        Task::status lstatus = left.getStatus ();
+        Task::status rstatus = right.getStatus ();
+        if (lstatus != Task::completed &&
+            lstatus != Task::deleted &&
+            rstatus != Task::completed &&
+            rstatus != Task::deleted)
         {
-          if (right.get ("uuid") == dep)
-          {
-            // GC hasn't run yet, check both tasks for their current status
-            Task::status lstatus = left.getStatus ();
-            Task::status rstatus = right.getStatus ();
-            if (lstatus != Task::completed &&
-                lstatus != Task::deleted &&
-                rstatus != Task::completed &&
-                rstatus != Task::deleted)
-            {
-              left.is_blocked = true;
-              right.is_blocking = true;
-            }
-
-            // Only want to break out of the "right" loop.
-            break;
-          }
+          left.is_blocked = true;
+          right.is_blocking = true;
         }
       }
     }
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Builds the forward and reverse dependency edges, unless they are current.
+void TF2::dependency_graph ()
+{
+  if (_graph_valid && _graph_size == _tasks.size ())
+    return;
+
+  _depends.assign (_tasks.size (), std::vector <std::string> ());
+  _dependents.clear ();
+
+  for (size_t i = 0; i < _tasks.size (); ++i)
+  {
+    if (_tasks[i].has ("depends"))
+    {
+      _depends[i] = _tasks[i].getDependencyUUIDs ();
+      for (auto& dep : _depends[i])
+      {
+        auto& edges = _dependents[dep];
+        if (edges.empty () || edges.back () != i)
+          edges.push_back (i);
+      }
+    }
+  }
+
+  _graph_size  = _tasks.size ();
+  _graph_valid = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unfinished tasks that depend on the given UUID.
+std::vector <Task> TF2::dependents (const std::string& uuid)
+{
+  if (! _loaded_tasks)
+    load_tasks ();
+
+  dependency_graph ();
+
+  std::vector <Task> tasks;
+  auto edges = _dependents.find (uuid);
+  if (edges != _dependents.end ())
+  {
+    for (auto position : edges->second)
+    {
+      auto status = _tasks[position].getStatus ();
+      if (status != Task::completed &&
+          status != Task::deleted)
+        tasks.push_back (_tasks[position]);
+    }
+  }
+
+  return tasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Unfinished tasks among the given UUIDs.
+std::vector <Task> TF2::dependencies (const std::vector <std::string>& uuids)
+{
+  if (! _loaded_tasks)
+    load_tasks ();
+
+  std::vector <long> positions;
+  for (auto& uuid : uuids)
+  {
+    auto position = find_exact (uuid);
+    if (position != -1)
+      positions.push_back (position);
+  }
+
+  std::sort (positions.begin (), positions.end ());
+  positions.erase (std::unique (positions.begin (), positions.end ()), positions.end ());
+
+  std::vector <Task> tasks;
+  for (auto position : positions)
+  {
+    auto status = _tasks[position].getStatus ();
+    if (status != Task::completed &&
+        status != Task::deleted)
+      tasks.push_back (_tasks[position]);
+  }
+
+  return tasks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The UUIDs that the given task depends on, if the task is in this file.
+bool TF2::get_dependencies (const std::string& uuid, std::vector <std::string>& uuids)
+{
+  if (! _loaded_tasks)
+    load_tasks ();
+
+  dependency_graph ();
+
+  auto position = find_exact (uuid);
+  if (position == -1)
+    return false;
+
+  uuids = _depends[position];
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 const std::string TF2::dump ()
 {
@@ -737,7 +2071,7 @@ void TDB2::update (
 ////////////////////////////////////////////////////////////////////////////////
 void TDB2::commit ()
 {
-  Timer timer;
+  Profiler::Scope scope ("commit");
 
   // Ignore harmful signals.
   signal (SIGHUP,    SIG_IGN);
@@ -761,8 +2095,6 @@ void TDB2::commit ()
   signal (SIGTERM,   SIG_DFL);
   signal (SIGUSR1,   SIG_DFL);
   signal (SIGUSR2,   SIG_DFL);
-
-  Context::getContext ().time_commit_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -855,6 +2187,10 @@ void TDB2::revert ()
     File::write (pending._file._data, p);
     File::write (completed._file._data, c);
     File::write (backlog._file._data, b);
+
+    // Any journal was already applied to the lines written.
+    pending.clear_journal ();
+    completed.clear_journal ();
   }
   else
     std::cout << "No changes made.\n";
@@ -1055,11 +2391,11 @@ void TDB2::show_diff (
       Task before (prior);
 
       std::vector <std::string> beforeAtts;
-      for (auto& att : before.data)
+      for (const auto& att : before.data)
         beforeAtts.push_back (att.first);
 
       std::vector <std::string> afterAtts;
-      for (auto& att : after.data)
+      for (const auto& att : after.data)
         afterAtts.push_back (att.first);
 
       std::vector <std::string> beforeOnly;
@@ -1074,7 +2410,7 @@ void TDB2::show_diff (
         view.set (row, 1, renderAttribute (name, before.get (name)), color_red);
       }
 
-      for (auto& att : before.data)
+      for (const auto& att : before.data)
       {
         std::string priorValue   = before.get (att.first);
         std::string currentValue = after.get  (att.first);
@@ -1100,7 +2436,7 @@ void TDB2::show_diff (
     else
     {
       int row;
-      for (auto& att : after.data)
+      for (const auto& att : after.data)
       {
         row = view.addRow ();
         view.set (row, 0, att.first);
@@ -1158,11 +2494,11 @@ void TDB2::show_diff (
     std::vector <std::string> all = Context::getContext ().getColumns ();
 
     // Now factor in the annotation attributes.
-    for (auto& it : before.data)
+    for (const auto& it : before.data)
       if (it.first.substr (0, 11) == "annotation_")
         all.push_back (it.first);
 
-    for (auto& it : after.data)
+    for (const auto& it : after.data)
       if (it.first.substr (0, 11) == "annotation_")
         all.push_back (it.first);
 
@@ -1247,44 +2583,55 @@ void TDB2::show_diff (
 // - waiting task in pending that needs to be un-waited
 void TDB2::gc ()
 {
-  Timer timer;
+  Profiler::Scope scope ("gc");
 
   // Allowed as an override, but not recommended.
   if (Context::getContext ().config.getBoolean ("gc"))
   {
-    // Load pending, check whether completed changes size
-    auto size_before = completed._tasks.size ();
-    pending.load_tasks (/*from_gc =*/ true);
-    if (size_before != completed._tasks.size ())
-    {
-      // GC moved tasks from pending to completed
-      pending._dirty = true;
-      completed._dirty = true;
-    }
-    else if (pending._dirty)
+    // GC happens as the files are loaded, so a file already loaded, by an
+    // earlier command in a batch, is left alone.
+    if (! pending._loaded_tasks)
     {
-      // A waiting task in pending was woken up
-      pending._dirty = true;
+      // Load pending, check whether completed changes size
+      auto size_before = completed._tasks.size ();
+      pending.load_tasks (/*from_gc =*/ true);
+      if (size_before != completed._tasks.size ())
+      {
+        // GC moved tasks from pending to completed
+        pending._dirty = true;
+        completed._dirty = true;
+      }
+      else if (pending._dirty)
+      {
+        // A waiting task in pending was woken up
+        pending._dirty = true;
+      }
     }
 
-    // Load completed, check whether pending changes size
-    size_before = pending._tasks.size ();
-    completed.load_tasks (/*from_gc =*/ true);
-    if (size_before != pending._tasks.size ())
+    if (! completed._loaded_tasks)
     {
-      // GC moved tasks from completed to pending
-      pending._dirty = true;
-      completed._dirty = true;
+      // Load completed, check whether pending changes size
+      auto size_before = pending._tasks.size ();
+      completed.load_tasks (/*from_gc =*/ true);
+      if (size_before != pending._tasks.size ())
+      {
+        // GC moved tasks from completed to pending
+        pending._dirty = true;
+        completed._dirty = true;
+      }
     }
 
+    // A large journal is compacted into its data file, rather than waiting
+    // for a modification to do it.
+    pending.compact_journal ();
+    completed.compact_journal ();
+
     // Update blocked/blocking status after GC is finished
     if (pending._auto_dep_scan)
       pending.dependency_scan ();
     if (completed._auto_dep_scan)
       completed.dependency_scan ();
   }
-
-  Context::getContext ().time_gc_us += timer.total_us ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1304,19 +2651,13 @@ int TDB2::latest_id ()
 ////////////////////////////////////////////////////////////////////////////////
 const std::vector <Task> TDB2::all_tasks ()
 {
-  std::vector <Task> all (pending._tasks.size () +
-                          pending._added_tasks.size () +
-                          completed._tasks.size () +
-                          completed._added_tasks.size ());
-  all = pending.get_tasks ();
-
-  std::vector <Task> extra (completed._tasks.size () +
-                            completed._added_tasks.size ());
-  extra = completed.get_tasks ();
-
-  for (auto& task : extra)
-    all.push_back (task);
+  auto& first  = pending.get_tasks ();
+  auto& second = completed.get_tasks ();
 
+  std::vector <Task> all;
+  all.reserve (first.size () + second.size ());
+  all.insert (all.end (), first.begin (), first.end ());
+  all.insert (all.end (), second.begin (), second.end ());
   return all;
 }
 
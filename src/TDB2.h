@@ -33,6 +33,7 @@
 #include <vector>
 #include <string>
 #include <stdio.h>
+#include <stdint.h>
 #include <FS.h>
 #include <Task.h>
 
@@ -48,6 +49,10 @@ public:
   const std::vector <Task>&        get_tasks ();
   const std::vector <std::string>& get_lines ();
 
+  // Partial loading, through the index.
+  bool get_tasks (const std::vector <std::string>&, std::vector <Task>&);
+  bool get_tasks (const std::string&, int64_t, int64_t, std::vector <Task>&);
+
   bool get (int, Task&);
   bool get (const std::string&, Task&);
   bool has (const std::string&);
@@ -58,12 +63,16 @@ public:
   void add_line (const std::string&);
   void clear_tasks ();
   void clear_lines ();
+  void clear_journal ();
+  void compact_journal ();
   void commit ();
 
   Task load_task (const std::string&);
+  void load_id (Task&);
   void load_gc (Task&);
   void load_tasks (bool from_gc = false);
   void load_lines ();
+  void preload ();
 
   // ID <--> UUID mapping.
   std::string uuid (int);
@@ -76,6 +85,11 @@ public:
 
   void dependency_scan ();
 
+  // Dependency graph queries.  Tasks are returned in file order.
+  std::vector <Task> dependents (const std::string&);
+  std::vector <Task> dependencies (const std::vector <std::string>&);
+  bool get_dependencies (const std::string&, std::vector <std::string>&);
+
   bool _read_only;
   bool _dirty;
   bool _loaded_tasks;
@@ -83,22 +97,88 @@ public:
   bool _has_ids;
   bool _auto_dep_scan;
   std::vector <Task> _tasks;
-
-  // _tasks_map was introduced mainly for speeding up "task import".
-  // Iterating over all _tasks for each imported task is slow, making use of
-  // appropriate data structures is fast.
-  std::unordered_map <std::string, Task> _tasks_map;
-
   std::vector <Task> _added_tasks;
   std::vector <Task> _modified_tasks;
   std::unordered_set <std::string> _purged_tasks;
   std::vector <std::string> _lines;
   std::vector <std::string> _added_lines;
+  std::vector <Task> _preloaded;
   File _file;
 
+  // Index record, locating a task in the file.
+  struct IndexEntry
+  {
+    char     uuid[36];
+    uint64_t offset;
+    uint32_t length;
+  };
+
+  // Index block, summarizing a contiguous run of records.
+  struct IndexBlock
+  {
+    uint64_t offset;
+    uint64_t length;
+    int64_t  min_end;
+    int64_t  max_end;
+    int64_t  min_entry;
+    int64_t  max_entry;
+  };
+
+private:
+  bool open_locked ();
+
+  const std::string snapshot_file () const;
+  bool load_snapshot (uint64_t, std::vector <Task>&);
+  void save_snapshot (uint64_t, const std::string&, uint32_t);
+
+  const std::string index_file () const;
+  bool use_index ();
+  bool load_index (bool header_only = false);
+  void save_index (std::vector <IndexEntry>&, const std::vector <IndexBlock>&);
+  bool read_record (FILE*, const IndexEntry&, Task&);
+
+  const std::string journal_file () const;
+  const std::string journal_header () const;
+  bool journal_active ();
+  bool journal_large (size_t) const;
+  bool journal_changes (std::vector <std::string>&);
+  bool write_journal (const std::vector <std::string>&);
+  void replay_journal ();
+
+  void parse_lines (std::vector <Task>&, std::vector <char>&) const;
+
+  void index_tasks ();
+  long find_task (const std::string&);
+  long find_exact (const std::string&);
+
+  void dependency_graph ();
+
 private:
   std::unordered_map <int, std::string> _I2U; // ID -> UUID map
   std::unordered_map <std::string, int> _U2I; // UUID -> ID map
+
+  // UUID -> position in _tasks, and the same sorted by UUID, for partial UUID
+  // matching.  Both are extended lazily, as _tasks grows.
+  std::unordered_map <std::string, size_t>      _uuid_index;
+  std::vector <std::pair <std::string, size_t>> _uuid_sorted;
+  size_t                                        _uuid_indexed {0};
+
+  // Dependency graph over _tasks.  Forward edges are the UUIDs each task
+  // depends on, reverse edges are the positions of the tasks depending on a
+  // UUID.  Rebuilt when _tasks grows, or a task is modified.
+  std::vector <std::vector <std::string>>                 _depends;
+  std::unordered_map <std::string, std::vector <size_t>> _dependents;
+  size_t                                                  _graph_size  {0};
+  bool                                                    _graph_valid {false};
+
+  std::string               _read_state    {};       // Size and mtime as last read
+  int                       _journal_state {0};      // 0 unknown, 1 active, -1 none
+  std::vector <std::string> _gc_records    {};       // Journal records for GC moves
+  bool                      _compact       {false};  // Fold the journal in on commit
+
+  int                      _index_state {0};  // 0 unknown, 1 loaded, -1 unusable
+  std::vector <IndexEntry> _index;            // Sorted by UUID
+  std::vector <IndexBlock> _index_blocks;     // In file order
 };
 
 // TDB2 Class represents all the files in the task database.
@@ -60,8 +60,6 @@
 
 #define APPROACHING_INFINITY 1000   // Close enough.  This isn't rocket surgery.
 
-extern Task& contextTask;
-
 static const float epsilon = 0.000001;
 #endif
 
@@ -70,9 +68,10 @@ std::string Task::defaultDue       = "";
 std::string Task::defaultScheduled = "";
 bool Task::searchCaseSensitive     = true;
 bool Task::regex                   = false;
-std::map <std::string, std::string> Task::attributes;
+std::unordered_map <std::string, std::string> Task::attributes;
 
 std::map <std::string, float> Task::coefficients;
+std::vector <Task::UrgencyRule> Task::urgencyRules;
 float Task::urgencyProjectCoefficient     = 0.0;
 float Task::urgencyActiveCoefficient      = 0.0;
 float Task::urgencyScheduledCoefficient   = 0.0;
@@ -89,6 +88,33 @@ std::map <std::string, std::vector <std::string>> Task::customOrder;
 
 static const std::string dummy ("");
 
+// Bits in Task::_cached.  The core dates use bits 0-7, by dateSlot.
+static const unsigned CACHED_STATUS = 1 << 8;
+static const unsigned CACHED_TAGS   = 1 << 9;
+
+////////////////////////////////////////////////////////////////////////////////
+// The core date attributes, which are cached once parsed.
+static int dateSlot (const std::string& name)
+{
+  static const char* dates[] = {"due", "end", "entry", "modified", "scheduled", "start", "until", "wait"};
+  for (int i = 0; i < 8; ++i)
+    if (name == dates[i])
+      return i;
+
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Orphans have no type, and are not added to Task::attributes by the lookup.
+static const std::string& attributeType (const std::string& name)
+{
+  auto i = Task::attributes.find (name);
+  if (i != Task::attributes.end ())
+    return i->second;
+
+  return dummy;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // The uuid and id attributes must be exempt from comparison.
 //
@@ -259,6 +285,18 @@ float Task::get_float (const std::string& name) const
 ////////////////////////////////////////////////////////////////////////////////
 time_t Task::get_date (const std::string& name) const
 {
+  auto slot = dateSlot (name);
+  if (slot != -1)
+  {
+    if (! cached (1u << slot))
+    {
+      _dates[slot] = (time_t) strtoul (get_ref (name).c_str (), nullptr, 10);
+      _cached |= 1u << slot;
+    }
+
+    return _dates[slot];
+  }
+
   auto i = data.find (name);
   if (i != data.end ())
     return (time_t) strtoul (i->second.c_str (), nullptr, 10);
@@ -298,10 +336,27 @@ void Task::remove (const std::string& name)
 ////////////////////////////////////////////////////////////////////////////////
 Task::status Task::getStatus () const
 {
-  if (! has ("status"))
-    return Task::pending;
+  if (! cached (CACHED_STATUS))
+  {
+    _status = has ("status") ? textToStatus (get_ref ("status")) : Task::pending;
+    _cached |= CACHED_STATUS;
+  }
 
-  return textToStatus (get ("status"));
+  return _status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Any change to data discards all the cached values.  Only const access is
+// used to rebuild them, so that it does not change the data version.
+bool Task::cached (unsigned bit) const
+{
+  if (_cache_version != data.version ())
+  {
+    _cached = 0;
+    _cache_version = data.version ();
+  }
+
+  return _cached & bit;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -317,30 +372,26 @@ void Task::setStatus (Task::status status)
 // Determines status of a date attribute.
 Task::dateState Task::getDateState (const std::string& name) const
 {
-  std::string value = get (name);
-  if (value.length ())
+  if (get_ref (name).length ())
   {
-    Datetime reference (value);
-    Datetime now;
-    Datetime today ("today");
+    auto reference = get_date (name);
+    auto& times = Context::getContext ().time_context.get ();
 
-    if (reference < today)
+    if (reference < times.today)
       return dateBeforeToday;
 
-    if (reference.sameDay (now))
+    if (reference < times.tomorrow)
     {
-      if (reference < now)
+      if (reference < times.now)
         return dateEarlierToday;
       else
         return dateLaterToday;
     }
 
-    int imminentperiod = Context::getContext ().config.getInteger ("due");
-    if (imminentperiod == 0)
+    if (times.imminent == 0)
       return dateAfterToday;
 
-    Datetime imminentDay = today + imminentperiod * 86400;
-    if (reference < imminentDay)
+    if (reference < times.imminent)
       return dateAfterToday;
   }
 
@@ -355,7 +406,7 @@ bool Task::is_ready () const
   return getStatus () == Task::pending &&
          ! is_blocked                  &&
          (! has ("scheduled")          ||
-          Datetime ("now").operator> (get_date ("scheduled")));
+          Context::getContext ().time_context.get ().now > get_date ("scheduled"));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -389,7 +440,10 @@ bool Task::is_dueyesterday () const
     if (status != Task::completed &&
         status != Task::deleted)
     {
-      if (Datetime ("yesterday").sameDay (get_date ("due")))
+      auto& times = Context::getContext ().time_context.get ();
+      auto due = get_date ("due");
+      if (due >= times.yesterday &&
+          due <  times.today)
         return true;
     }
   }
@@ -427,7 +481,10 @@ bool Task::is_duetomorrow () const
     if (status != Task::completed &&
         status != Task::deleted)
     {
-      if (Datetime ("tomorrow").sameDay (get_date ("due")))
+      auto& times = Context::getContext ().time_context.get ();
+      auto due = get_date ("due");
+      if (due >= times.tomorrow &&
+          due <  times.overmorrow)
         return true;
     }
   }
@@ -445,9 +502,10 @@ bool Task::is_dueweek () const
     if (status != Task::completed &&
         status != Task::deleted)
     {
-      Datetime due (get_date ("due"));
-      if (due >= Datetime ("sow") &&
-          due <= Datetime ("eow"))
+      auto& times = Context::getContext ().time_context.get ();
+      auto due = get_date ("due");
+      if (due >= times.sow &&
+          due <= times.eow)
         return true;
     }
   }
@@ -465,9 +523,10 @@ bool Task::is_duemonth () const
     if (status != Task::completed &&
         status != Task::deleted)
     {
-      Datetime due (get_date ("due"));
-      if (due >= Datetime ("som") &&
-          due <= Datetime ("eom"))
+      auto& times = Context::getContext ().time_context.get ();
+      auto due = get_date ("due");
+      if (due >= times.som &&
+          due <= times.eom)
         return true;
     }
   }
@@ -485,9 +544,10 @@ bool Task::is_duequarter () const
     if (status != Task::completed &&
         status != Task::deleted)
     {
-      Datetime due (get_date ("due"));
-      if (due >= Datetime ("soq") &&
-          due <= Datetime ("eoq"))
+      auto& times = Context::getContext ().time_context.get ();
+      auto due = get_date ("due");
+      if (due >= times.soq &&
+          due <= times.eoq)
         return true;
     }
   }
@@ -505,9 +565,10 @@ bool Task::is_dueyear () const
     if (status != Task::completed &&
         status != Task::deleted)
     {
-      Datetime due (get_date ("due"));
-      if (due >= Datetime ("soy") &&
-          due <= Datetime ("eoy"))
+      auto& times = Context::getContext ().time_context.get ();
+      auto due = get_date ("due");
+      if (due >= times.soy &&
+          due <= times.eoy)
         return true;
     }
   }
@@ -529,7 +590,7 @@ bool Task::is_udaPresent () const
 ////////////////////////////////////////////////////////////////////////////////
 bool Task::is_orphanPresent () const
 {
-  for (auto& att : data)
+  for (const auto& att : data)
     if (att.first.compare (0, 11, "annotation_", 11) != 0)
       if (Context::getContext ().columns.find (att.first) == Context::getContext ().columns.end ())
         return true;
@@ -579,45 +640,7 @@ void Task::parse (const std::string& input)
     data.clear ();
 
     if (input[0] == '[')
-    {
-      Pig pig (input);
-      std::string line;
-      if (pig.skip     ('[')       &&
-          pig.getUntil (']', line) &&
-          pig.skip     (']')       &&
-          (pig.skip ('\n') || pig.eos ()))
-      {
-        if (line.length () == 0)
-          throw std::string ("Empty record in input.");
-
-        Pig attLine (line);
-        std::string name;
-        std::string value;
-        while (!attLine.eos ())
-        {
-          if (attLine.getUntil (':', name) &&
-              attLine.skip (':')           &&
-              attLine.getQuoted ('"', value))
-          {
-#ifdef PRODUCT_TASKWARRIOR
-            legacyAttributeMap (name);
-#endif
-
-            if (! name.compare (0, 11, "annotation_", 11))
-              ++annotation_count;
-
-            data[name] = decode (json::decode (value));
-          }
-
-          attLine.skip (' ');
-        }
-
-        std::string remainder;
-        attLine.getRemainder (remainder);
-        if (remainder.length ())
-          throw std::string ("Unrecognized characters at end of line.");
-      }
-    }
+      parseF4 (input);
     else if (input[0] == '{')
       parseJSON (input);
     else
@@ -632,6 +655,51 @@ void Task::parse (const std::string& input)
   recalc_urgency = true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Parses a file format version 4 record, throwing if it is malformed.  Unlike
+// parse, there is no fallback to legacy formats, and no access to the Context,
+// so records may be parsed concurrently.
+void Task::parseF4 (const std::string& input)
+{
+  Pig pig (input);
+  std::string line;
+  if (pig.skip     ('[')       &&
+      pig.getUntil (']', line) &&
+      pig.skip     (']')       &&
+      (pig.skip ('\n') || pig.eos ()))
+  {
+    if (line.length () == 0)
+      throw std::string ("Empty record in input.");
+
+    Pig attLine (line);
+    std::string name;
+    std::string value;
+    while (!attLine.eos ())
+    {
+      if (attLine.getUntil (':', name) &&
+          attLine.skip (':')           &&
+          attLine.getQuoted ('"', value))
+      {
+#ifdef PRODUCT_TASKWARRIOR
+        legacyAttributeMap (name);
+#endif
+
+        if (! name.compare (0, 11, "annotation_", 11))
+          ++annotation_count;
+
+        data[name] = decode (json::decode (value));
+      }
+
+      attLine.skip (' ');
+    }
+
+    std::string remainder;
+    attLine.getRemainder (remainder);
+    if (remainder.length ())
+      throw std::string ("Unrecognized characters at end of line.");
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Note that all fields undergo encode/decode.
 void Task::parseJSON (const std::string& line)
@@ -652,7 +720,7 @@ void Task::parseJSON (const json::object* root_obj)
   for (auto& i : root_obj->_data)
   {
     // If the attribute is a recognized column.
-    std::string type = Task::attributes[i.first];
+    auto& type = attributeType (i.first);
     if (type != "")
     {
       // Any specified id is ignored.
@@ -839,9 +907,7 @@ std::string Task::composeF4 () const
   for (auto it : data)
   {
     // Orphans have no type, treat as string.
-    std::string type = Task::attributes[it.first];
-    if (type == "")
-      type = "string";
+    auto& type = attributeType (it.first);
 
     // If there is a value.
     if (it.second != "")
@@ -849,7 +915,7 @@ std::string Task::composeF4 () const
       ff4 += (first ? "" : " ");
       ff4 += it.first;
       ff4 += ":\"";
-      if (type == "string")
+      if (type == "string" || type == "")
         ff4 += encode (json::encode (it.second));
       else
         ff4 += it.second;
@@ -876,7 +942,7 @@ std::string Task::composeJSON (bool decorate /*= false*/) const
 
   // First the non-annotations.
   int attributes_written = 0;
-  for (auto& i : data)
+  for (const auto& i : data)
   {
     // Annotations are not written out here.
     if (! i.first.compare (0, 11, "annotation_", 11))
@@ -889,9 +955,8 @@ std::string Task::composeJSON (bool decorate /*= false*/) const
     if (attributes_written)
       out << ',';
 
-    std::string type = Task::attributes[i.first];
-    if (type == "")
-      type = "string";
+    // Orphans have no type, treat as string.
+    auto& type = attributeType (i.first);
 
     // Date fields are written as ISO 8601.
     if (type == "date")
@@ -988,7 +1053,7 @@ std::string Task::composeJSON (bool decorate /*= false*/) const
       out << '"'
           << i.first
           << "\":\""
-          << (type == "string" ? json::encode (i.second) : i.second)
+          << (type == "string" || type == "" ? json::encode (i.second) : i.second)
           << '"';
 
       ++attributes_written;
@@ -1002,7 +1067,7 @@ std::string Task::composeJSON (bool decorate /*= false*/) const
         << "\"annotations\":[";
 
     int annotations_written = 0;
-    for (auto& i : data)
+    for (const auto& i : data)
     {
       if (! i.first.compare (0, 11, "annotation_", 11))
       {
@@ -1039,7 +1104,7 @@ std::string Task::composeJSON (bool decorate /*= false*/) const
 int Task::getAnnotationCount () const
 {
   int count = 0;
-  for (auto& ann : data)
+  for (const auto& ann : data)
     if (! ann.first.compare (0, 11, "annotation_", 11))
       ++count;
 
@@ -1085,10 +1150,10 @@ void Task::removeAnnotations ()
     if (! i->first.compare (0, 11, "annotation_", 11))
     {
       --annotation_count;
-      data.erase (i++);
+      i = data.erase (i);
     }
     else
-      i++;
+      ++i;
   }
 
   recalc_urgency = true;
@@ -1098,9 +1163,9 @@ void Task::removeAnnotations ()
 std::map <std::string, std::string> Task::getAnnotations () const
 {
   std::map <std::string, std::string> a;
-  for (auto& ann : data)
+  for (const auto& ann : data)
     if (! ann.first.compare (0, 11, "annotation_", 11))
-      a.insert (ann);
+      a.insert ({ann.first, ann.second});
 
   return a;
 }
@@ -1233,8 +1298,7 @@ std::vector <Task> Task::getDependencyTasks () const
 ////////////////////////////////////////////////////////////////////////////////
 int Task::getTagCount () const
 {
-  auto tags = split (get ("tags"), ',');
-  return (int) tags.size ();
+  return (int) getTags ().size ();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1294,7 +1358,7 @@ bool Task::hasTag (const std::string& tag) const
   }
 
   // Concrete tags.
-  auto tags = split (get ("tags"), ',');
+  auto& tags = getTags ();
 
   if (std::find (tags.begin (), tags.end (), tag) != tags.end ())
     return true;
@@ -1305,7 +1369,7 @@ bool Task::hasTag (const std::string& tag) const
 ////////////////////////////////////////////////////////////////////////////////
 void Task::addTag (const std::string& tag)
 {
-  auto tags = split (get ("tags"), ',');
+  auto tags = getTags ();
 
   if (std::find (tags.begin (), tags.end (), tag) == tags.end ())
   {
@@ -1328,15 +1392,21 @@ void Task::addTags (const std::vector <std::string>& tags)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-std::vector <std::string> Task::getTags () const
+const std::vector <std::string>& Task::getTags () const
 {
-  return split (get ("tags"), ',');
+  if (! cached (CACHED_TAGS))
+  {
+    _tags = split (get_ref ("tags"), ',');
+    _cached |= CACHED_TAGS;
+  }
+
+  return _tags;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Task::removeTag (const std::string& tag)
 {
-  auto tags = split (get ("tags"), ',');
+  auto tags = getTags ();
 
   auto i = std::find (tags.begin (), tags.end (), tag);
   if (i != tags.end ())
@@ -1354,7 +1424,7 @@ void Task::removeTag (const std::string& tag)
 std::vector <std::string> Task::getUDAOrphanUUIDs () const
 {
   std::vector <std::string> orphans;
-  for (auto& it : data)
+  for (const auto& it : data)
     if (it.first.compare (0, 11, "annotation_", 11) != 0)
       if (Context::getContext ().columns.find (it.first) == Context::getContext ().columns.end ())
         orphans.push_back (it.first);
@@ -1804,110 +1874,261 @@ int Task::determineVersion (const std::string& line)
 //
 float Task::urgency_c () const
 {
-  float value = 0.0;
+  float value;
+  const Task* task = this;
+  urgency_batch (&task, 1, &value);
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+float Task::urgency ()
+{
+  if (recalc_urgency)
+  {
+    urgency_value = urgency_c ();
+
+    // Return the sum of all terms.
+    recalc_urgency = false;
+  }
+
+  return urgency_value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Computes and caches urgency for all the tasks that need it, in one batch.
+void Task::urgency (std::vector <Task>& tasks)
+{
+  std::vector <const Task*> stale;
+  for (auto& task : tasks)
+    if (task.recalc_urgency)
+      stale.push_back (&task);
+
+  std::vector <float> values (stale.size ());
+  urgency_batch (stale.data (), stale.size (), values.data ());
+
+  for (size_t i = 0; i < stale.size (); ++i)
+  {
+    auto task = const_cast <Task*> (stale[i]);
+    task->urgency_value = values[i];
+    task->recalc_urgency = false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Each term is gathered into a column over the whole batch, then weighted and
+// summed in a loop with no branches or lookups, which the compiler vectorizes.
+void Task::urgency_batch (const Task* const* tasks, size_t count, float* value)
+{
+  std::fill (value, value + count, 0.0f);
 #ifdef PRODUCT_TASKWARRIOR
-  value += fabsf (Task::urgencyProjectCoefficient)     > epsilon ? (urgency_project ()     * Task::urgencyProjectCoefficient)     : 0.0;
-  value += fabsf (Task::urgencyActiveCoefficient)      > epsilon ? (urgency_active ()      * Task::urgencyActiveCoefficient)      : 0.0;
-  value += fabsf (Task::urgencyScheduledCoefficient)   > epsilon ? (urgency_scheduled ()   * Task::urgencyScheduledCoefficient)   : 0.0;
-  value += fabsf (Task::urgencyWaitingCoefficient)     > epsilon ? (urgency_waiting ()     * Task::urgencyWaitingCoefficient)     : 0.0;
-  value += fabsf (Task::urgencyBlockedCoefficient)     > epsilon ? (urgency_blocked ()     * Task::urgencyBlockedCoefficient)     : 0.0;
-  value += fabsf (Task::urgencyAnnotationsCoefficient) > epsilon ? (urgency_annotations () * Task::urgencyAnnotationsCoefficient) : 0.0;
-  value += fabsf (Task::urgencyTagsCoefficient)        > epsilon ? (urgency_tags ()        * Task::urgencyTagsCoefficient)        : 0.0;
-  value += fabsf (Task::urgencyDueCoefficient)         > epsilon ? (urgency_due ()         * Task::urgencyDueCoefficient)         : 0.0;
-  value += fabsf (Task::urgencyBlockingCoefficient)    > epsilon ? (urgency_blocking ()    * Task::urgencyBlockingCoefficient)    : 0.0;
-  value += fabsf (Task::urgencyAgeCoefficient)         > epsilon ? (urgency_age ()         * Task::urgencyAgeCoefficient)         : 0.0;
-
-  // Tag- and project-specific coefficients.
-  for (auto& var : Task::coefficients)
+  std::vector <float> term (count);
+  auto weigh = [&] (float coefficient)
   {
-    if (fabs (var.second) > epsilon)
-    {
-      if (! var.first.compare (0, 13, "urgency.user.", 13))
-      {
-        // urgency.user.project.<project>.coefficient
-        auto end = std::string::npos;
-        if (var.first.substr (13, 8) == "project." &&
-            (end = var.first.find (".coefficient")) != std::string::npos)
-        {
-          std::string project = var.first.substr (21, end - 21);
+    for (size_t i = 0; i < count; ++i)
+      value[i] += term[i] * coefficient;
+  };
 
-          if (get ("project").find (project) == 0)
-            value += var.second;
-        }
+  auto now = Context::getContext ().time_context.get ().now;
+  if (fabsf (Task::urgencyProjectCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_project ();
+    weigh (Task::urgencyProjectCoefficient);
+  }
 
-        // urgency.user.tag.<tag>.coefficient
-        if (var.first.substr (13, 4) == "tag." &&
-            (end = var.first.find (".coefficient")) != std::string::npos)
-        {
-          std::string tag = var.first.substr (17, end - 17);
+  if (fabsf (Task::urgencyActiveCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_active ();
+    weigh (Task::urgencyActiveCoefficient);
+  }
 
-          if (hasTag (tag))
-            value += var.second;
-        }
+  if (fabsf (Task::urgencyScheduledCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_scheduled (now);
+    weigh (Task::urgencyScheduledCoefficient);
+  }
 
-        // urgency.user.keyword.<keyword>.coefficient
-        if (var.first.substr (13, 8) == "keyword." &&
-            (end = var.first.find (".coefficient")) != std::string::npos)
-        {
-          std::string keyword = var.first.substr (21, end - 21);
+  if (fabsf (Task::urgencyWaitingCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_waiting ();
+    weigh (Task::urgencyWaitingCoefficient);
+  }
 
-          if (get ("description").find (keyword) != std::string::npos)
-            value += var.second;
-        }
-      }
-      else if (var.first.substr (0, 12) == "urgency.uda.")
+  if (fabsf (Task::urgencyBlockedCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_blocked ();
+    weigh (Task::urgencyBlockedCoefficient);
+  }
+
+  if (fabsf (Task::urgencyAnnotationsCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_annotations ();
+    weigh (Task::urgencyAnnotationsCoefficient);
+  }
+
+  if (fabsf (Task::urgencyTagsCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_tags ();
+    weigh (Task::urgencyTagsCoefficient);
+  }
+
+  if (fabsf (Task::urgencyDueCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_due (now);
+    weigh (Task::urgencyDueCoefficient);
+  }
+
+  if (fabsf (Task::urgencyBlockingCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_blocking ();
+    weigh (Task::urgencyBlockingCoefficient);
+  }
+
+  if (fabsf (Task::urgencyAgeCoefficient) > epsilon)
+  {
+    for (size_t i = 0; i < count; ++i)
+      term[i] = tasks[i]->urgency_age (now);
+    weigh (Task::urgencyAgeCoefficient);
+  }
+
+  // Tag-, project-, keyword- and UDA-specific coefficients.
+  if (Task::urgencyRules.size ())
+    for (size_t i = 0; i < count; ++i)
+      value[i] += tasks[i]->urgency_rules ();
+
+  // Inherited urgency needs the urgency of other tasks, so is not batched.
+  if (Context::getContext ().config.getBoolean ("urgency.inherit"))
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (tasks[i]->is_blocking)
       {
-        // urgency.uda.<name>.coefficient
-        // urgency.uda.<name>.<value>.coefficient
-        auto end = var.first.find (".coefficient");
-        if (end != std::string::npos)
-        {
-          const std::string uda = var.first.substr (12, end - 12);
-          auto dot = uda.find ('.');
-          if (dot == std::string::npos)
-          {
-            // urgency.uda.<name>.coefficient
-            if (has (uda))
-              value += var.second;
-          }
-          else
-          {
-            // urgency.uda.<name>.<value>.coefficient
-            if (get (uda.substr(0, dot)) == uda.substr(dot+1))
-              value += var.second;
-          }
-        }
+        float prev = value[i];
+        value[i] = std::max (value[i], tasks[i]->urgency_inherit ());
+
+        // This is a hackish way of making sure parent tasks are sorted above
+        // child tasks.  For reports that hide blocked tasks, this is not needed.
+        if (prev < value[i])
+          value[i] += 0.01;
       }
     }
   }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+float Task::urgency_rules () const
+{
+  float value = 0.0;
 
-  if (is_blocking && Context::getContext ().config.getBoolean ("urgency.inherit"))
+  for (auto& rule : Task::urgencyRules)
   {
-    float prev = value;
-    value = std::max (value, urgency_inherit ());
+    switch (rule.kind)
+    {
+    case UrgencyRule::Kind::project:
+      if (get_ref ("project").find (rule.name) == 0)
+        value += rule.coefficient;
+      break;
+
+    case UrgencyRule::Kind::tag:
+      if (hasTag (rule.name))
+        value += rule.coefficient;
+      break;
 
-    // This is a hackish way of making sure parent tasks are sorted above
-    // child tasks.  For reports that hide blocked tasks, this is not needed.
-    if (prev < value)
-      value += 0.01;
+    case UrgencyRule::Kind::keyword:
+      if (get_ref ("description").find (rule.name) != std::string::npos)
+        value += rule.coefficient;
+      break;
+
+    case UrgencyRule::Kind::uda:
+      if (has (rule.name))
+        value += rule.coefficient;
+      break;
+
+    case UrgencyRule::Kind::uda_value:
+      if (get_ref (rule.name) == rule.value)
+        value += rule.coefficient;
+      break;
+    }
   }
-#endif
 
   return value;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-float Task::urgency ()
+// Decodes the names of Task::coefficients once, so that urgency computation
+// does no string parsing.
+//
+//   urgency.user.project.<project>.coefficient
+//   urgency.user.tag.<tag>.coefficient
+//   urgency.user.keyword.<keyword>.coefficient
+//   urgency.uda.<name>.coefficient
+//   urgency.uda.<name>.<value>.coefficient
+//
+void Task::compileUrgencyRules ()
 {
-  if (recalc_urgency)
+  Task::urgencyRules.clear ();
+  for (auto& var : Task::coefficients)
   {
-    urgency_value = urgency_c ();
+    if (fabs (var.second) <= epsilon)
+      continue;
 
-    // Return the sum of all terms.
-    recalc_urgency = false;
-  }
+    auto end = var.first.find (".coefficient");
+    if (end == std::string::npos)
+      continue;
 
-  return urgency_value;
+    UrgencyRule rule;
+    rule.coefficient = var.second;
+
+    if (! var.first.compare (0, 13, "urgency.user.", 13))
+    {
+      if (var.first.substr (13, 8) == "project.")
+      {
+        rule.kind = UrgencyRule::Kind::project;
+        rule.name = var.first.substr (21, end - 21);
+      }
+      else if (var.first.substr (13, 4) == "tag.")
+      {
+        rule.kind = UrgencyRule::Kind::tag;
+        rule.name = var.first.substr (17, end - 17);
+      }
+      else if (var.first.substr (13, 8) == "keyword.")
+      {
+        rule.kind = UrgencyRule::Kind::keyword;
+        rule.name = var.first.substr (21, end - 21);
+      }
+      else
+        continue;
+    }
+    else if (var.first.substr (0, 12) == "urgency.uda.")
+    {
+      const std::string uda = var.first.substr (12, end - 12);
+      auto dot = uda.find ('.');
+      if (dot == std::string::npos)
+      {
+        rule.kind = UrgencyRule::Kind::uda;
+        rule.name = uda;
+      }
+      else
+      {
+        rule.kind = UrgencyRule::Kind::uda_value;
+        rule.name = uda.substr (0, dot);
+        rule.value = uda.substr (dot + 1);
+      }
+    }
+    else
+      continue;
+
+    Task::urgencyRules.push_back (rule);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1915,7 +2136,7 @@ float Task::urgency_inherit () const
 {
   float v = FLT_MIN;
 #ifdef PRODUCT_TASKWARRIOR
-  // Calling dependencyGetBlocked is rather expensive.
+  // dependencyGetBlocked copies each blocked task.
   // It is called recursively for each dependency in the chain here.
   for (auto& task : dependencyGetBlocked (*this))
   {
@@ -1946,10 +2167,10 @@ float Task::urgency_active () const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-float Task::urgency_scheduled () const
+float Task::urgency_scheduled (time_t now) const
 {
   if (has ("scheduled") &&
-      get_date ("scheduled") < time (nullptr))
+      get_date ("scheduled") < now)
     return 1.0;
 
   return 0.0;
@@ -2007,15 +2228,12 @@ float Task::urgency_tags () const
 //     capped                                                        capped
 //
 //
-float Task::urgency_due () const
+float Task::urgency_due (time_t now) const
 {
   if (has ("due"))
   {
-    Datetime now;
-    Datetime due (get_date ("due"));
-
     // Map a range of 21 days to the value 0.2 - 1.0
-    float days_overdue = (now - due) / 86400.0;
+    float days_overdue = (now - get_date ("due")) / 86400.0;
          if (days_overdue >= 7.0)   return 1.0;   // < 1 wk ago
     else if (days_overdue >= -14.0) return ((days_overdue + 14.0) * 0.8 / 21.0) + 0.2;
     else                            return 0.2;   // > 2 wks
@@ -2025,13 +2243,11 @@ float Task::urgency_due () const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-float Task::urgency_age () const
+float Task::urgency_age (time_t now) const
 {
   assert (has ("entry"));
 
-  Datetime now;
-  Datetime entry (get_date ("entry"));
-  int age = (now - entry) / 86400;  // in days
+  int age = (now - get_date ("entry")) / 86400;  // in days
 
   if (Task::urgencyAgeMax == 0 || age > Task::urgencyAgeMax)
     return 1.0;
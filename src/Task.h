@@ -29,10 +29,12 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <stdio.h>
 #include <time.h>
 #include <JSON.h>
+#include <AttributeMap.h>
 
 class Task
 {
@@ -42,8 +44,21 @@ public:
   static std::string defaultScheduled;
   static bool searchCaseSensitive;
   static bool regex;
-  static std::map <std::string, std::string> attributes;  // name -> type
+  static std::unordered_map <std::string, std::string> attributes;  // name -> type
   static std::map <std::string, float> coefficients;
+
+  // The urgency.user.* and urgency.uda.* coefficients, compiled.
+  struct UrgencyRule
+  {
+    enum class Kind { project, tag, keyword, uda, uda_value };
+
+    Kind        kind;
+    std::string name;
+    std::string value;
+    float       coefficient;
+  };
+  static std::vector <UrgencyRule> urgencyRules;
+  static void compileUrgencyRules ();
   static std::map <std::string, std::vector <std::string>> customOrder;
   static float urgencyProjectCoefficient;
   static float urgencyActiveCoefficient;
@@ -64,6 +79,7 @@ public:
   Task (const json::object*);
 
   void parse (const std::string&);
+  void parseF4 (const std::string&);
   std::string composeF4 () const;
   std::string composeJSON (bool decorate = false) const;
 
@@ -74,7 +90,7 @@ public:
   enum dateState {dateNotDue, dateAfterToday, dateLaterToday, dateEarlierToday, dateBeforeToday};
 
   // Public data.
-  std::map <std::string, std::string> data {};
+  AttributeMap data {};
   int id                                   {0};
   float urgency_value                      {0.0};
   bool recalc_urgency                      {true};
@@ -126,7 +142,7 @@ public:
   bool hasTag (const std::string&) const;
   void addTag (const std::string&);
   void addTags (const std::vector <std::string>&);
-  std::vector <std::string> getTags () const;
+  const std::vector <std::string>& getTags () const;
   void removeTag (const std::string&);
 
   int getAnnotationCount () const;
@@ -156,6 +172,7 @@ public:
 
   float urgency_c () const;
   float urgency ();
+  static void urgency (std::vector <Task>&);
 
 #ifdef PRODUCT_TASKWARRIOR
   enum modType {modReplace, modPrepend, modAppend, modAnnotate};
@@ -170,19 +187,31 @@ private:
   void validate_before (const std::string&, const std::string&);
   const std::string encode (const std::string&) const;
   const std::string decode (const std::string&) const;
+  static void urgency_batch (const Task* const*, size_t, float*);
+  float urgency_rules () const;
+  bool cached (unsigned) const;
 
 public:
   float urgency_project     () const;
   float urgency_active      () const;
-  float urgency_scheduled   () const;
+  float urgency_scheduled   (time_t now = time (nullptr)) const;
   float urgency_waiting     () const;
   float urgency_blocked     () const;
   float urgency_inherit     () const;
   float urgency_annotations () const;
   float urgency_tags        () const;
-  float urgency_due         () const;
+  float urgency_due         (time_t now = time (nullptr)) const;
   float urgency_blocking    () const;
-  float urgency_age         () const;
+  float urgency_age         (time_t now = time (nullptr)) const;
+
+private:
+  // Parsed forms of the tags, the status and the core dates, each with a bit
+  // in _cached.  They are valid while data is at _cache_version.
+  mutable std::vector <std::string> _tags          {};
+  mutable time_t                    _dates[8]      {};
+  mutable status                    _status        {pending};
+  mutable unsigned                  _cached        {0};
+  mutable unsigned long             _cache_version {0};
 };
 
 #endif
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <TimeContext.h>
+#include <Context.h>
+#include <Datetime.h>
+
+////////////////////////////////////////////////////////////////////////////////
+// The start of the day 'offset' days from the given time, in local time.
+static time_t startOfDay (time_t when, int offset)
+{
+  struct tm t;
+  localtime_r (&when, &t);
+  t.tm_hour = t.tm_min = t.tm_sec = 0;
+  t.tm_mday += offset;
+  t.tm_isdst = -1;
+  return mktime (&t);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const TimeContext::Boundaries& TimeContext::get ()
+{
+  if (! _valid)
+  {
+    auto& b = _boundaries;
+    b.now        = time (nullptr);
+    b.yesterday  = startOfDay (b.now, -1);
+    b.today      = startOfDay (b.now, 0);
+    b.tomorrow   = startOfDay (b.now, 1);
+    b.overmorrow = startOfDay (b.now, 2);
+    b.sow        = Datetime ("sow").toEpoch ();
+    b.eow        = Datetime ("eow").toEpoch ();
+    b.som        = Datetime ("som").toEpoch ();
+    b.eom        = Datetime ("eom").toEpoch ();
+    b.soq        = Datetime ("soq").toEpoch ();
+    b.eoq        = Datetime ("eoq").toEpoch ();
+    b.soy        = Datetime ("soy").toEpoch ();
+    b.eoy        = Datetime ("eoy").toEpoch ();
+
+    auto imminentperiod = Context::getContext ().config.getInteger ("due");
+    b.imminent   = imminentperiod ? b.today + imminentperiod * 86400 : 0;
+
+    _valid = true;
+  }
+
+  return _boundaries;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TimeContext::reset ()
+{
+  _valid = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef INCLUDED_TIMECONTEXT
+#define INCLUDED_TIMECONTEXT
+
+#include <time.h>
+
+// TimeContext holds "now", and the boundaries of the surrounding days, week,
+// month, quarter and year, so that date predicates compare epoch values
+// instead of constructing and comparing Datetime objects.  They are computed
+// on first use, and stay fixed until reset, so that one command sees one
+// consistent "now".  Computing them is not thread-safe, so the first use
+// after a reset must be on the main thread.
+class TimeContext
+{
+public:
+  struct Boundaries
+  {
+    time_t now;
+    time_t yesterday;    // Start of yesterday
+    time_t today;        // Start of today
+    time_t tomorrow;     // Start of tomorrow
+    time_t overmorrow;   // Start of the day after tomorrow
+    time_t sow;
+    time_t eow;
+    time_t som;
+    time_t eom;
+    time_t soq;
+    time_t eoq;
+    time_t soy;
+    time_t eoy;
+    time_t imminent;     // End of the rc.due period, or 0 if there is none
+  };
+
+  const Boundaries& get ();
+  void reset ();
+
+private:
+  Boundaries _boundaries {};
+  bool       _valid      {false};
+};
+
+#endif
+////////////////////////////////////////////////////////////////////////////////
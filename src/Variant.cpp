@@ -34,7 +34,7 @@
 #include <Datetime.h>
 #include <Duration.h>
 #include <Lexer.h>
-#include <RX.h>
+#include <AttributeMap.h>
 #include <shared.h>
 
 // These are all error messages generated by the expression evaluator, and are
@@ -92,19 +92,6 @@ std::string Variant::dateFormat = "";
 bool Variant::searchCaseSensitive = true;
 bool Variant::searchUsingRegex = true;
 
-////////////////////////////////////////////////////////////////////////////////
-Variant::Variant (const Variant& other)
-{
-  _type     = other._type;
-  _bool     = other._bool;
-  _integer  = other._integer;
-  _real     = other._real;
-  _string   = other._string;
-  _date     = other._date;
-  _duration = other._duration;
-  _source   = other._source;
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 Variant::Variant (const bool value)
 : _type (Variant::type_boolean)
@@ -156,28 +143,22 @@ Variant::Variant (const time_t value, const enum type new_type)
 ////////////////////////////////////////////////////////////////////////////////
 void Variant::source (const std::string& input)
 {
-  _source = input;
+  _source = AttributeMap::intern (input);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-const std::string& Variant::source () const
+// Takes a name already interned by AttributeMap::intern, which saves the
+// lookup when the same source is set repeatedly.
+void Variant::source (const std::string* input)
 {
-  return _source;
+  _source = input;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-Variant& Variant::operator= (const Variant& other)
+const std::string& Variant::source () const
 {
-  _type     = other._type;
-  _bool     = other._bool;
-  _integer  = other._integer;
-  _real     = other._real;
-  _string   = other._string;
-  _date     = other._date;
-  _duration = other._duration;
-  _source   = other._source;
-
-  return *this;
+  static const std::string none;
+  return _source ? *_source : none;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -897,71 +878,60 @@ bool Variant::operator!= (const Variant& other) const
 ////////////////////////////////////////////////////////////////////////////////
 bool Variant::operator_match (const Variant& other, const Task& task) const
 {
-  // Simple matching case first.
-  Variant left (*this);
-  Variant right (other);
-
-  if (left._type == type_string)
-    Lexer::dequote (left._string);
+  return operator_match (other.matcher (), task);
+}
 
-  if (right._type == type_string)
-    Lexer::dequote (right._string);
+////////////////////////////////////////////////////////////////////////////////
+// Matches against a pattern prepared by matcher (), which may be reused.
+bool Variant::operator_match (const Matcher& matcher, const Task& task) const
+{
+  // An unquoted string is matched in place, without a copy.
+  const std::string* text = &_string;
+  std::string converted;
+  if (_type != type_string ||
+      (_string.length ()                             &&
+       (_string[0] == '\'' || _string[0] == '"') &&
+       _string[0] == _string[_string.length () - 1]))
+  {
+    Variant left (*this);
+    if (left._type == type_string)
+      Lexer::dequote (left._string);
 
-  left.cast (type_string);
-  right.cast (type_string);
+    left.cast (type_string);
+    converted = std::move (left._string);
+    text = &converted;
+  }
 
-  std::string pattern = right._string;
-  Lexer::dequote (pattern);
+  if (matcher.match (*text))
+    return true;
 
-  if (searchUsingRegex)
+  // If the above did not match, and the left source is "description", then
+  // in the annotations.
+  if (source () == "description")
   {
-    RX r (pattern, searchCaseSensitive);
-    if (r.match (left._string))
-      return true;
-
-    // If the above did not match, and the left source is "description", then
-    // in the annotations.
-    if (left.source () == "description")
-    {
-      for (auto& a : task.getAnnotations ())
-        if (r.match (a.second))
-          return true;
-    }
+    for (auto& a : task.getAnnotations ())
+      if (matcher.search (a.second))
+        return true;
   }
-  else
-  {
-    // If pattern starts with '^', look for a leftmost compare only.
-    if (pattern[0] == '^' &&
-        find (left._string,
-              pattern.substr (1),
-              searchCaseSensitive) == 0)
-    {
-      return true;
-    }
 
-    // If pattern ends with '$', look for a rightmost compare only.
-    else if (pattern[pattern.length () - 1] == '$' &&
-             find (left._string,
-                   pattern.substr (0, pattern.length () - 1),
-                   searchCaseSensitive) == (left._string.length () - pattern.length () + 1))
-    {
-      return true;
-    }
+  return false;
+}
 
-    else if (find (left._string, pattern, searchCaseSensitive) != std::string::npos)
-      return true;
+////////////////////////////////////////////////////////////////////////////////
+// Prepares this value as the pattern of a match, under the current search
+// settings.
+Matcher Variant::matcher () const
+{
+  Variant right (*this);
+  if (right._type == type_string)
+    Lexer::dequote (right._string);
 
-    // If the above did not match, and the left source is "description", then
-    // in the annotations.
-    if (left.source () == "description")
-    {
-      for (auto& a : task.getAnnotations ())
-        if (find (a.second, pattern, searchCaseSensitive) != std::string::npos)
-          return true;
-    }
-  }
+  right.cast (type_string);
 
-  return false;
+  std::string pattern = right._string;
+  Lexer::dequote (pattern);
+
+  return Matcher (pattern, searchCaseSensitive, searchUsingRegex);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -970,6 +940,26 @@ bool Variant::operator_nomatch (const Variant& other, const Task& task) const
   return ! operator_match (other, task);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool Variant::operator_nomatch (const Matcher& matcher, const Task& task) const
+{
+  return ! operator_match (matcher, task);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Whether two times fall on the same local day.  Uses localtime_r rather than
+// Datetime, which breaks dates down in static storage.
+static bool sameDay (time_t left, time_t right)
+{
+  struct tm l;
+  struct tm r;
+  localtime_r (&left, &l);
+  localtime_r (&right, &r);
+  return l.tm_year == r.tm_year &&
+         l.tm_mon  == r.tm_mon  &&
+         l.tm_mday == r.tm_mday;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Partial match is mostly a clone of operator==, but with some overrides:
 //
@@ -1001,9 +991,7 @@ bool Variant::operator_partial (const Variant& other) const
     case type_date:
       {
         left.cast (type_date);
-        Datetime left_date (left._date);
-        Datetime right_date (right._date);
-        return left_date.sameDay (right_date);
+        return sameDay (left._date, right._date);
       }
 
     case type_duration: left.cast (type_duration); return left._duration == right._duration;
@@ -1022,9 +1010,7 @@ bool Variant::operator_partial (const Variant& other) const
     case type_date:
       {
         left.cast (type_date);
-        Datetime left_date (left._date);
-        Datetime right_date (right._date);
-        return left_date.sameDay (right_date);
+        return sameDay (left._date, right._date);
       }
 
     case type_duration: left.cast (type_duration); return left._duration == right._duration;
@@ -1048,9 +1034,7 @@ bool Variant::operator_partial (const Variant& other) const
     case type_date:
       {
         left.cast (type_date);
-        Datetime left_date (left._date);
-        Datetime right_date (right._date);
-        return left_date.sameDay (right_date);
+        return sameDay (left._date, right._date);
       }
 
     case type_duration:
@@ -1094,9 +1078,7 @@ bool Variant::operator_partial (const Variant& other) const
           return false;
 
         left.cast (type_date);
-        Datetime left_date (left._date);
-        Datetime right_date (right._date);
-        return left_date.sameDay (right_date);
+        return sameDay (left._date, right._date);
       }
 
     case type_duration:
@@ -1120,9 +1102,7 @@ bool Variant::operator_partial (const Variant& other) const
     case type_duration:
       {
         right.cast (type_date);
-        Datetime left_date (left._date);
-        Datetime right_date (right._date);
-        return left_date.sameDay (right_date);
+        return sameDay (left._date, right._date);
       }
     }
     break;
@@ -1967,21 +1947,23 @@ bool Variant::trivial () const
 }
 
 ////////////////////////////////////////////////////////////////////////////////
+// The scalar accessors return zero for other types, as the union only holds
+// the value of the current type.
 bool Variant::get_bool () const
 {
-  return _bool;
+  return _type == type_boolean ? _bool : false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 int Variant::get_integer () const
 {
-  return _integer;
+  return _type == type_integer ? _integer : 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 double Variant::get_real () const
 {
-  return _real;
+  return _type == type_real ? _real : 0.0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1993,13 +1975,13 @@ const std::string& Variant::get_string () const
 ////////////////////////////////////////////////////////////////////////////////
 time_t Variant::get_date () const
 {
-  return _date;
+  return _type == type_date ? _date : 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 time_t Variant::get_duration () const
 {
-  return _duration;
+  return _type == type_duration ? _duration : 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
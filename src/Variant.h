@@ -31,6 +31,7 @@
 #include <string>
 #include <time.h>
 #include <Task.h>
+#include <Matcher.h>
 
 class Variant
 {
@@ -43,7 +44,8 @@ public:
   enum type {type_boolean, type_integer, type_real, type_string, type_date, type_duration};
 
   Variant () = default;
-  Variant (const Variant&);
+  Variant (const Variant&) = default;
+  Variant (Variant&&) noexcept = default;
   Variant (const bool);
   Variant (const int);
   Variant (const double);
@@ -52,9 +54,11 @@ public:
   Variant (const time_t, const enum type);
 
   void source (const std::string&);
+  void source (const std::string*);
   const std::string& source () const;
 
-  Variant& operator= (const Variant&);
+  Variant& operator= (const Variant&) = default;
+  Variant& operator= (Variant&&) noexcept = default;
 
   bool operator&& (const Variant&) const;
   bool operator|| (const Variant&) const;
@@ -67,6 +71,8 @@ public:
   bool operator!= (const Variant&) const;
   bool operator_match (const Variant&, const Task&) const;
   bool operator_nomatch (const Variant&, const Task&) const;
+  bool operator_match (const Matcher&, const Task&) const;
+  bool operator_nomatch (const Matcher&, const Task&) const;
   bool operator_partial (const Variant&) const;
   bool operator_nopartial (const Variant&) const;
   bool operator_hastag (const Variant&, const Task&) const;
@@ -97,6 +103,7 @@ public:
   void cast (const enum type);
   int type ();
   bool trivial () const;
+  Matcher matcher () const;
 
   bool               get_bool () const;
   int                get_integer () const;
@@ -106,15 +113,21 @@ public:
   time_t             get_duration () const;
 
 private:
-  enum type   _type     {type_boolean};
-  bool        _bool     {false};
-  int         _integer  {0};
-  double      _real     {0.0};
-  std::string _string   {""};
-  time_t      _date     {0};
-  time_t      _duration {0};
-
-  std::string _source   {""};
+  // Only the member for _type is meaningful.  Strings keep their value when
+  // cast to another type.
+  enum type _type {type_boolean};
+  union
+  {
+    bool    _bool;
+    int     _integer;
+    double  _real;
+    time_t  _date {0};
+    time_t  _duration;
+  };
+  std::string _string {};
+
+  // Interned, so that copying a Variant does not copy its source.
+  const std::string* _source {nullptr};
 };
 
 #endif
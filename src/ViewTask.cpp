@@ -33,6 +33,9 @@
 #include <utf8.h>
 #include <main.h>
 
+// Streamed output is written in chunks of at least this many bytes.
+static const size_t STREAM_CHUNK = 65536;
+
 ////////////////////////////////////////////////////////////////////////////////
 ViewTask::ViewTask ()
 : _width (0)
@@ -51,6 +54,8 @@ ViewTask::ViewTask ()
 , _truncate_rows (0)
 , _lines (0)
 , _rows (0)
+, _streaming (false)
+, _sample (0)
 {
 }
 
@@ -105,10 +110,14 @@ ViewTask::~ViewTask ()
 // Note: an enhancement to the 'no solution' problem is to simply force-break
 //       the larger fields.  If the widest field is W0, and the second widest
 //       field is W1, then a solution may be achievable by reducing W0 --> W1.
+// Streaming: when a stream is set, the rendered lines are written to it in
+//            chunks as they are composed, and render returns an empty string.
+//            Widths are then measured over the first 'sample' rows only, so
+//            that output can start before the whole report is composed.
 //
 std::string ViewTask::render (std::vector <Task>& data, std::vector <int>& sequence)
 {
-  Timer timer;
+  Profiler::Scope scope ("render");
 
   bool const obfuscate           = Context::getContext ().config.getBoolean ("obfuscate");
   bool const print_empty_columns = Context::getContext ().config.getBoolean ("print.empty.columns");
@@ -133,6 +142,9 @@ std::string ViewTask::render (std::vector <Task>& data, std::vector <int>& seque
       if ((int)s >= _truncate_rows && _truncate_rows != 0)
         break;
 
+      if ((int)s >= _sample && _sample != 0)
+        break;
+
       // Determine minimum and ideal width for this column.
       unsigned int min = 0;
       unsigned int ideal = 0;
@@ -284,10 +296,7 @@ std::string ViewTask::render (std::vector <Task>& data, std::vector <int>& seque
 
     // Stop if the line limit is exceeded.
     if (++_lines >= _truncate_lines && _truncate_lines != 0)
-    {
-      Context::getContext ().time_render_us += timer.total_us ();
-      return out;
-    }
+      return flush (out);
   }
 
   // Compose, render columns, in sequence.
@@ -370,24 +379,31 @@ std::string ViewTask::render (std::vector <Task>& data, std::vector <int>& seque
 
       // Stop if the line limit is exceeded.
       if (++_lines >= _truncate_lines && _truncate_lines != 0)
-      {
-        Context::getContext ().time_render_us += timer.total_us ();
-        return out;
-      }
+        return flush (out);
     }
 
     cells.clear ();
 
     // Stop if the row limit is exceeded.
     if (++_rows >= _truncate_rows && _truncate_rows != 0)
-    {
-      Context::getContext ().time_render_us += timer.total_us ();
-      return out;
-    }
+      return flush (out);
+
+    if (_streaming && out.length () >= STREAM_CHUNK)
+      flush (out);
   }
+  return flush (out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writes any composed output, if streaming.
+std::string ViewTask::flush (std::string& out)
+{
+  if (! _streaming)
+    return out;
 
-  Context::getContext ().time_render_us += timer.total_us ();
-  return out;
+  Context::getContext ().output (out);
+  out.clear ();
+  return "";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
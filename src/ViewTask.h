@@ -56,12 +56,16 @@ public:
   void truncateLines (int n)                   { _truncate_lines = n;                                 }
   void truncateRows (int n)                    { _truncate_rows = n;                                  }
   void addBreak (const std::string& attr)      { _breaks.push_back (attr);                            }
+  void stream (int sample)                     { _streaming = true; _sample = sample;                 }
   int lines ()                                 { return _lines;                                       }
   int rows ()                                  { return _rows;                                        }
 
   // View rendering.
   std::string render (std::vector <Task>&, std::vector <int>&);
 
+private:
+  std::string flush (std::string&);
+
 private:
   std::vector <Column*>     _columns;
   std::vector <bool>        _sort;
@@ -82,6 +86,8 @@ private:
   int                       _truncate_rows;
   int                       _lines;
   int                       _rows;
+  bool                      _streaming;
+  int                       _sample;
 };
 
 #endif
@@ -36,8 +36,6 @@
 #include <utf8.h>
 #include <main.h>
 
-extern Task& contextTask;
-
 ////////////////////////////////////////////////////////////////////////////////
 ColumnTags::ColumnTags ()
 {
@@ -167,7 +165,7 @@ void ColumnTags::modify (Task& task, const std::string& value)
     {
       Eval e;
       e.addSource (domSource);
-      contextTask = task;
+      ContextTask bind (task);
 
       Variant v;
       e.evaluateInfixExpression (value, v);
@@ -34,8 +34,6 @@
 #include <Filter.h>
 #include <format.h>
 
-extern Task& contextTask;
-
 ////////////////////////////////////////////////////////////////////////////////
 ColumnTypeDate::ColumnTypeDate ()
 {
@@ -213,7 +211,7 @@ void ColumnTypeDate::modify (Task& task, const std::string& value)
   {
     Eval e;
     e.addSource (domSource);
-    contextTask = task;
+    ContextTask bind (task);
     e.evaluateInfixExpression (value, evaluatedValue);
   }
 
@@ -0,0 +1,226 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+#include <CmdBatch.h>
+#include <iostream>
+#include <Context.h>
+#include <Lexer.h>
+#include <format.h>
+#include <shared.h>
+
+////////////////////////////////////////////////////////////////////////////////
+CmdBatch::CmdBatch ()
+{
+  _keyword               = "batch";
+  _usage                 = "task          batch [<file>]";
+  _description           = "Runs the commands in a file, or STDIN, as one";
+  _read_only             = false;
+  _displays_id           = false;
+  _needs_gc              = true;
+  _uses_context          = false;
+  _accepts_filter        = false;
+  _accepts_modifications = false;
+  _accepts_miscellaneous = true;
+  _category              = Command::Category::misc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Each line holds the arguments of one command, as they would follow 'task' on
+// the command line.  The commands all run against the data as loaded, and
+// garbage collected, once, so IDs keep the meaning they had when the batch
+// started.  The changes are committed when the batch ends, or every
+// 'batch.commit' commands.  All the commands are read before the first one
+// runs, so that any confirmation a command asks for does not consume input.
+// The output of each command is written as it completes, so that reports
+// that stream their output stay in order.
+int CmdBatch::execute (std::string& output)
+{
+  auto& context = Context::getContext ();
+  auto words = context.cli2.getWords ();
+
+  std::vector <std::string> lines;
+  if (! words.size () ||
+      (words.size () == 1 && words[0] == "-"))
+  {
+    std::string line;
+    while (std::getline (std::cin, line))
+      lines.push_back (line);
+  }
+  else if (words.size () == 1)
+  {
+    File input (words[0]);
+    if (! input.exists ())
+      throw format ("File '{1}' not found.", words[0]);
+
+    input.read (lines);
+  }
+  else
+    throw std::string ("A batch is read from a single file.");
+
+  auto every = context.config.getInteger ("batch.commit");
+  auto original = context.cli2;
+  auto binary = original._original_args[0].attribute ("raw");
+
+  auto rc = 0;
+  auto count = 0;
+  auto failed = 0;
+  auto uncommitted = 0;
+  for (unsigned int i = 0; i < lines.size (); ++i)
+  {
+    auto line = Lexer::trim (lines[i], " \t\r");
+    if (line == "" || line[0] == '#')
+      continue;
+
+    ++count;
+    int status;
+    try
+    {
+      // Each command is parsed on its own, with the entities and aliases of
+      // the batch.
+      CLI2 parser;
+      parser._entities = original._entities;
+      parser._aliases  = original._aliases;
+      parser.add (binary);
+
+      // The configuration is shared by the whole batch, so an override on one
+      // line cannot apply to that line alone.
+      auto terminated = false;
+      for (auto& arg : split (line))
+      {
+        if (arg == "--")
+          terminated = true;
+        else if (! terminated &&
+                 (arg.substr (0, 3) == "rc." ||
+                  arg.substr (0, 3) == "rc:"))
+          throw format ("The override '{1}' is not supported on a batch line, only on the batch command line.", arg);
+
+        parser.add (arg);
+      }
+
+      parser.analyze ();
+      if (parser.getCommand () == _keyword)
+        throw std::string ("A batch cannot run another batch.");
+
+      context.cli2 = parser;
+
+      std::string out;
+      status = context.dispatch (out);
+      context.output (out);
+    }
+
+    catch (const std::string& error)
+    {
+      context.error (format ("Batch line {1}: {2}", i + 1, error));
+      status = 2;
+    }
+
+    catch (int)
+    {
+      // Hooks can terminate processing by throwing integers.
+      status = 4;
+    }
+
+    context.footnote (format ("Batch line {1}, status {2}: {3}", i + 1, status, line));
+    if (status)
+    {
+      ++failed;
+      if (! rc)
+        rc = status;
+    }
+
+    if (every > 0 &&
+        ++uncommitted == every)
+    {
+      context.tdb2.commit ();
+      uncommitted = 0;
+    }
+  }
+
+  context.cli2 = original;
+  context.footnote (format ("Batch ran {1} commands, {2} failed.", count, failed));
+  return rc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Splits a line into arguments, as a shell would: whitespace separates them,
+// single and double quotes group them, and a backslash escapes the next
+// character.
+std::vector <std::string> CmdBatch::split (const std::string& line) const
+{
+  std::vector <std::string> args;
+  std::string arg;
+  bool inArg = false;
+  char quote = 0;
+
+  for (std::string::size_type i = 0; i < line.length (); ++i)
+  {
+    auto c = line[i];
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+      else if (c == '\\' && quote == '"' && i + 1 < line.length ())
+        arg += line[++i];
+      else
+        arg += c;
+    }
+    else if (c == '\'' || c == '"')
+    {
+      quote = c;
+      inArg = true;
+    }
+    else if (c == '\\' && i + 1 < line.length ())
+    {
+      arg += line[++i];
+      inArg = true;
+    }
+    else if (c == ' ' || c == '\t')
+    {
+      if (inArg)
+        args.push_back (arg);
+
+      arg = "";
+      inArg = false;
+    }
+    else
+    {
+      arg += c;
+      inArg = true;
+    }
+  }
+
+  if (quote)
+    throw std::string ("Unterminated quote.");
+
+  if (inArg)
+    args.push_back (arg);
+
+  return args;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -53,13 +53,13 @@ int CmdCount::execute (std::string& output)
   handleUntil ();
   handleRecurrence ();
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   // Find number of matching tasks.  Skip recurring parent tasks.
   int count = 0;
-  for (const auto& task : filtered)
-    if (task.getStatus () != Task::recurring)
+  for (auto task : filtered)
+    if (task->getStatus () != Task::recurring)
       ++count;
 
   output = format (count) + '\n';
@@ -31,6 +31,8 @@
 #include <vector>
 #include <algorithm>
 #include <stdlib.h>
+#include <unistd.h>
+#include <iostream>
 #include <Context.h>
 #include <Filter.h>
 #include <Lexer.h>
@@ -94,6 +96,11 @@ int CmdCustom::execute (std::string& output)
   std::vector <Task> filtered;
   filter.subset (filtered);
 
+  // Report output can be limited by rows or lines.
+  auto maxrows = 0;
+  auto maxlines = 0;
+  Context::getContext ().getLimits (maxrows, maxlines);
+
   std::vector <int> sequence;
   if (sortOrder.size () &&
       sortOrder[0] == "none")
@@ -114,9 +121,10 @@ int CmdCustom::execute (std::string& output)
     for (unsigned int i = 0; i < filtered.size (); ++i)
       sequence.push_back (i);
 
-    // Sort the tasks.
+    // Sort the tasks.  A limited report shows at most one task per row or
+    // line, so only that many need to be in order.
     if (sortOrder.size ())
-      sort_tasks (filtered, sequence, reportSort);
+      sort_tasks (filtered, sequence, reportSort, maxrows ? maxrows : maxlines);
   }
 
   // Configure the view.
@@ -184,11 +192,6 @@ int CmdCustom::execute (std::string& output)
       table_header = 2;  // Dashes use an extra line.
   }
 
-  // Report output can be limited by rows or lines.
-  auto maxrows = 0;
-  auto maxlines = 0;
-  Context::getContext ().getLimits (maxrows, maxlines);
-
   // Adjust for fluff in the output.
   if (maxlines)
     maxlines -= table_header
@@ -204,9 +207,20 @@ int CmdCustom::execute (std::string& output)
     view.truncateRows (maxrows);
     view.truncateLines (maxlines);
 
-    out << optionalBlankLine ()
-        << view.render (filtered, sequence)
-        << optionalBlankLine ();
+    // Reports to a pipe are streamed as they are rendered, rather than held
+    // until the whole report is composed.
+    auto sample = Context::getContext ().config.getInteger ("stream.sample");
+    if (sample > 0 && ! isatty (STDOUT_FILENO))
+    {
+      Context::getContext ().output (optionalBlankLine ());
+      view.stream (sample);
+      view.render (filtered, sequence);
+      out << optionalBlankLine ();
+    }
+    else
+      out << optionalBlankLine ()
+          << view.render (filtered, sequence)
+          << optionalBlankLine ();
 
     // Print the number of rendered tasks
     if (Context::getContext ().verbose ("affected"))
@@ -57,11 +57,11 @@ int CmdExport::execute (std::string& output)
 
   // Apply filter.
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   // Export == render.
-  Timer timer;
+  Profiler::Scope scope ("render");
 
   // Obey 'limit:N'.
   int rows = 0;
@@ -77,7 +77,7 @@ int CmdExport::execute (std::string& output)
     output += "[\n";
 
   int counter = 0;
-  for (auto& task : filtered)
+  for (auto task : filtered)
   {
     if (counter)
     {
@@ -86,7 +86,7 @@ int CmdExport::execute (std::string& output)
       output += '\n';
     }
 
-    output += task.composeJSON (true);
+    output += task->composeJSON (true);
 
     ++counter;
     if (limit && counter >= limit)
@@ -98,8 +98,6 @@ int CmdExport::execute (std::string& output)
 
   if (json_array)
     output += "]\n";
-
-  Context::getContext ().time_render_us += timer.total_us ();
   return rc;
 }
 
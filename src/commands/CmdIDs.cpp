@@ -58,14 +58,14 @@ int CmdIDs::execute (std::string& output)
   handleUntil ();
   handleRecurrence ();
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   // Find number of matching tasks.
   std::vector <int> ids;
-  for (auto& task : filtered)
-    if (task.id)
-      ids.push_back (task.id);
+  for (auto task : filtered)
+    if (task->id)
+      ids.push_back (task->id);
 
   std::sort (ids.begin (), ids.end ());
   output = compressIds (ids) + '\n';
@@ -152,14 +152,14 @@ int CmdCompletionIds::execute (std::string& output)
   handleUntil ();
   handleRecurrence ();
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   std::vector <int> ids;
-  for (auto& task : filtered)
-    if (task.getStatus () != Task::deleted &&
-        task.getStatus () != Task::completed)
-      ids.push_back (task.id);
+  for (auto task : filtered)
+    if (task->getStatus () != Task::deleted &&
+        task->getStatus () != Task::completed)
+      ids.push_back (task->id);
 
   std::sort (ids.begin (), ids.end ());
   output = join ("\n", ids) + '\n';
@@ -191,16 +191,16 @@ int CmdZshCompletionIds::execute (std::string& output)
   handleUntil ();
   handleRecurrence ();
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   std::stringstream out;
-  for (auto& task : filtered)
-    if (task.getStatus () != Task::deleted &&
-        task.getStatus () != Task::completed)
-      out << task.id
+  for (auto task : filtered)
+    if (task->getStatus () != Task::deleted &&
+        task->getStatus () != Task::completed)
+      out << task->id
           << ':'
-          << str_replace(task.get ("description"), ":", zshColonReplacement)
+          << str_replace(task->get ("description"), ":", zshColonReplacement)
           << '\n';
 
   output = out.str ();
@@ -232,12 +232,12 @@ int CmdUUIDs::execute (std::string& output)
   handleUntil ();
   handleRecurrence ();
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   std::vector <std::string> uuids;
-  for (auto& task : filtered)
-    uuids.push_back (task.get ("uuid"));
+  for (auto task : filtered)
+    uuids.push_back (task->get ("uuid"));
 
   std::sort (uuids.begin (), uuids.end ());
   output = join (" ", uuids) + '\n';
@@ -269,12 +269,12 @@ int CmdCompletionUuids::execute (std::string& output)
   handleUntil ();
   handleRecurrence ();
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   std::vector <std::string> uuids;
-  for (auto& task : filtered)
-    uuids.push_back (task.get ("uuid"));
+  for (auto task : filtered)
+    uuids.push_back (task->get ("uuid"));
 
   std::sort (uuids.begin (), uuids.end ());
   output = join ("\n", uuids) + '\n';
@@ -306,14 +306,14 @@ int CmdZshCompletionUuids::execute (std::string& output)
   handleUntil ();
   handleRecurrence ();
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   std::stringstream out;
-  for (auto& task : filtered)
-    out << task.get ("uuid")
+  for (auto task : filtered)
+    out << task->get ("uuid")
         << ':'
-        << str_replace (task.get ("description"), ":", zshColonReplacement)
+        << str_replace (task->get ("description"), ":", zshColonReplacement)
         << '\n';
 
   output = out.str ();
@@ -60,15 +60,17 @@ int CmdProjects::execute (std::string& output)
   // Get all the tasks.
   handleUntil ();
   handleRecurrence ();
-  auto tasks = Context::getContext ().tdb2.pending.get_tasks ();
+  std::vector <const Task*> tasks;
+  for (auto& task : Context::getContext ().tdb2.pending.get_tasks ())
+    tasks.push_back (&task);
 
   if (Context::getContext ().config.getBoolean ("list.all.projects"))
     for (auto& task : Context::getContext ().tdb2.completed.get_tasks ())
-      tasks.push_back (task);
+      tasks.push_back (&task);
 
   // Apply the filter.
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (tasks, filtered);
   int quantity = filtered.size ();
 
@@ -79,9 +81,9 @@ int CmdProjects::execute (std::string& output)
   std::map <std::string, int> unique;
   bool no_project = false;
   std::string project;
-  for (auto& task : filtered)
+  for (auto task : filtered)
   {
-    if (task.getStatus () == Task::deleted)
+    if (task->getStatus () == Task::deleted)
     {
       --quantity;
       continue;
@@ -89,7 +91,7 @@ int CmdProjects::execute (std::string& output)
 
     // Increase the count for the project the task belongs to and all
     // its super-projects
-    project = task.get ("project");
+    project = task->get ("project");
 
     std::vector <std::string> projects = extractParents (project);
     projects.push_back (project);
@@ -172,22 +174,24 @@ int CmdCompletionProjects::execute (std::string& output)
   // Get all the tasks.
   handleUntil ();
   handleRecurrence ();
-  auto tasks = Context::getContext ().tdb2.pending.get_tasks ();
+  std::vector <const Task*> tasks;
+  for (auto& task : Context::getContext ().tdb2.pending.get_tasks ())
+    tasks.push_back (&task);
 
   if (Context::getContext ().config.getBoolean ("list.all.projects"))
     for (auto& task : Context::getContext ().tdb2.completed.get_tasks ())
-      tasks.push_back (task);
+      tasks.push_back (&task);
 
   // Apply the filter.
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (tasks, filtered);
 
   // Scan all the tasks for their project name, building a map using project
   // names as keys.
   std::map <std::string, int> unique;
-  for (auto& task : filtered)
-    unique[task.get ("project")] = 0;
+  for (auto task : filtered)
+    unique[task->get ("project")] = 0;
 
   for (auto& project : unique)
     if (project.first.length ())
@@ -80,6 +80,7 @@ int CmdShow::execute (std::string& output)
     " active.indicator"
     " allow.empty.filter"
     " avoidlastcolumn"
+    " batch.commit"
     " bulk"
     " calendar.details"
     " calendar.details.report"
@@ -132,6 +133,7 @@ int CmdShow::execute (std::string& output)
     " complete.all.tags"
     " confirmation"
     " context"
+    " data.journal"
     " data.location"
     " dateformat"
     " dateformat.annotation"
@@ -160,12 +162,14 @@ int CmdShow::execute (std::string& output)
     " editor"
     " exit.on.missing.db"
     " expressions"
+    " filter.threads"
     " fontunderline"
     " gc"
     " hooks"
     " hyphenate"
     " indent.annotation"
     " indent.report"
+    " index"
     " journal.info"
     " journal.time"
     " journal.time.start.annotation"
@@ -179,6 +183,7 @@ int CmdShow::execute (std::string& output)
     " nag"
     " obfuscate"
     " print.empty.columns"
+    " profile"
     " recurrence"
     " recurrence.confirmation"
     " recurrence.indicator"
@@ -189,6 +194,8 @@ int CmdShow::execute (std::string& output)
     " rule.color.merge"
     " rule.precedence.color"
     " search.case.sensitive"
+    " snapshot"
+    " stream.sample"
     " sugar"
     " summary.all.projects"
     " tag.indicator"
@@ -58,25 +58,27 @@ int CmdTags::execute (std::string& output)
   std::stringstream out;
 
   // Get all the tasks.
-  auto tasks = Context::getContext ().tdb2.pending.get_tasks ();
+  std::vector <const Task*> tasks;
+  for (auto& task : Context::getContext ().tdb2.pending.get_tasks ())
+    tasks.push_back (&task);
 
   if (Context::getContext ().config.getBoolean ("list.all.tags"))
     for (auto& task : Context::getContext ().tdb2.completed.get_tasks ())
-      tasks.push_back (task);
+      tasks.push_back (&task);
 
   int quantity = tasks.size ();
 
   // Apply filter.
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (tasks, filtered);
 
   // Scan all the tasks for their project name, building a map using project
   // names as keys.
   std::map <std::string, int> unique;
-  for (auto& task : filtered)
+  for (auto task : filtered)
   {
-    for (auto& tag : task.getTags ())
+    for (auto& tag : task->getTags ())
       if (unique.find (tag) != unique.end ())
         unique[tag]++;
       else
@@ -157,22 +159,24 @@ CmdCompletionTags::CmdCompletionTags ()
 int CmdCompletionTags::execute (std::string& output)
 {
   // Get all the tasks.
-  auto tasks = Context::getContext ().tdb2.pending.get_tasks ();
+  std::vector <const Task*> tasks;
+  for (auto& task : Context::getContext ().tdb2.pending.get_tasks ())
+    tasks.push_back (&task);
 
   if (Context::getContext ().config.getBoolean ("complete.all.tags"))
     for (auto& task : Context::getContext ().tdb2.completed.get_tasks ())
-      tasks.push_back (task);
+      tasks.push_back (&task);
 
   // Apply filter.
   Filter filter;
-  std::vector <Task> filtered;
+  std::vector <const Task*> filtered;
   filter.subset (filtered);
 
   // Scan all the tasks for their tags, building a map using tag
   // names as keys.
   std::map <std::string, int> unique;
-  for (auto& task : filtered)
-    for (auto& tag : task.getTags ())
+  for (auto task : filtered)
+    for (auto& tag : task->getTags ())
       unique[tag] = 0;
 
   // Add built-in tags to map.
@@ -133,7 +133,7 @@ int CmdUDAs::execute (std::string& output)
   std::map <std::string, int> orphans;
   for (auto& i : filtered)
   {
-    for (auto& att : i.data)
+    for (const auto& att : i.data)
       if (att.first.substr (0, 11) != "annotation_" &&
           Context::getContext ().columns.find (att.first) == Context::getContext ().columns.end ())
         orphans[att.first]++;
@@ -39,6 +39,7 @@
 #include <CmdAnnotate.h>
 #include <CmdAppend.h>
 #include <CmdAttributes.h>
+#include <CmdBatch.h>
 #include <CmdBurndown.h>
 #include <CmdCalc.h>
 #include <CmdCalendar.h>
@@ -98,6 +99,7 @@ void Command::factory (std::map <std::string, Command*>& all)
   c = new CmdAdd ();                all[c->keyword ()] = c;
   c = new CmdAnnotate ();           all[c->keyword ()] = c;
   c = new CmdAppend ();             all[c->keyword ()] = c;
+  c = new CmdBatch ();              all[c->keyword ()] = c;
   c = new CmdBurndownDaily ();      all[c->keyword ()] = c;
   c = new CmdBurndownMonthly ();    all[c->keyword ()] = c;
   c = new CmdBurndownWeekly ();     all[c->keyword ()] = c;
@@ -0,0 +1,686 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// https://www.opensource.org/licenses/mit-license.php
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <cmake.h>
+// cmake.h include header must come first
+
+#include <iostream>
+#include <sstream>
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <Context.h>
+#include <Lexer.h>
+#include <format.h>
+#include <main.h>
+
+extern char** environ;
+
+// A request larger than this is not a command line.
+#define MAX_REQUEST (16 * 1024 * 1024)
+
+static volatile sig_atomic_t stopping = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+static void stop (int)
+{
+  stopping = 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool readAll (int fd, void* data, size_t length)
+{
+  auto p = static_cast <char*> (data);
+  while (length)
+  {
+    auto n = read (fd, p, length);
+    if (n == -1 && errno == EINTR)
+      continue;
+
+    if (n <= 0)
+      return false;
+
+    p += n;
+    length -= n;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool writeAll (int fd, const void* data, size_t length)
+{
+  auto p = static_cast <const char*> (data);
+  while (length)
+  {
+    auto n = write (fd, p, length);
+    if (n == -1 && errno == EINTR)
+      continue;
+
+    if (n <= 0)
+      return false;
+
+    p += n;
+    length -= n;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool address (const std::string& path, sockaddr_un& result)
+{
+  result = sockaddr_un ();
+  result.sun_family = AF_UNIX;
+  if (path.length () >= sizeof result.sun_path)
+    return false;
+
+  strcpy (result.sun_path, path.c_str ());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static int connectTo (const std::string& path)
+{
+  sockaddr_un remote;
+  if (! address (path, remote))
+    return -1;
+
+  int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1)
+    return -1;
+
+  if (connect (fd, (sockaddr*) &remote, sizeof remote) == -1)
+  {
+    close (fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Only the user that runs the daemon may use it.
+static bool trusted (int client)
+{
+#if defined (SO_PEERCRED)
+  struct ucred peer;
+  socklen_t length = sizeof peer;
+  if (getsockopt (client, SOL_SOCKET, SO_PEERCRED, &peer, &length) == -1)
+    return false;
+
+  return peer.uid == geteuid ();
+#else
+  uid_t uid;
+  gid_t gid;
+  if (getpeereid (client, &uid, &gid) == -1)
+    return false;
+
+  return uid == geteuid ();
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Creates the socket, readable only by the user, in a directory that only the
+// user can reach.  A socket left behind by a daemon that is no longer running
+// is replaced.
+static int listenOn (const std::string& path)
+{
+  sockaddr_un local;
+  if (! address (path, local))
+    throw format ("The socket path '{1}' is too long.", path);
+
+  auto slash = path.rfind ('/');
+  std::string directory = slash == std::string::npos ? "." :
+                          slash == 0                 ? "/" :
+                                                       path.substr (0, slash);
+  struct stat d;
+  if (lstat (directory.c_str (), &d) == -1 ||
+      ! S_ISDIR (d.st_mode)               ||
+      d.st_uid != geteuid ()              ||
+      (d.st_mode & 077))
+    throw format ("The socket must be in a directory owned by you, and not accessible to others, which '{1}' is not.", directory);
+
+  int probe = connectTo (path);
+  if (probe != -1)
+  {
+    close (probe);
+    throw format ("A daemon is already listening on '{1}'.", path);
+  }
+
+  struct stat s;
+  if (stat (path.c_str (), &s) == 0)
+  {
+    if (! S_ISSOCK (s.st_mode))
+      throw format ("'{1}' exists, and is not a socket.", path);
+
+    unlink (path.c_str ());
+  }
+
+  int fd = socket (AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1)
+    throw format ("Could not create a socket: {1}", strerror (errno));
+
+  auto mask = umask (0077);
+  auto bound = bind (fd, (sockaddr*) &local, sizeof local);
+  umask (mask);
+
+  if (bound == -1 ||
+      listen (fd, 16) == -1)
+  {
+    auto error = errno;
+    close (fd);
+    throw format ("Could not listen on '{1}': {2}", path, strerror (error));
+  }
+
+  fcntl (fd, F_SETFD, FD_CLOEXEC);
+  return fd;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The request is a length, carrying the client's stdin, stdout and stderr,
+// followed by the working directory, argc, argv and the environment, each
+// terminated by a NUL.
+static bool sendRequest (int fd, const std::string& request)
+{
+  int fds[3] {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+  uint32_t length = request.length ();
+  iovec iov {&length, sizeof length};
+
+  union
+  {
+    cmsghdr header;
+    char    buffer[CMSG_SPACE (sizeof fds)];
+  } control;
+  memset (&control, 0, sizeof control);
+
+  msghdr message {};
+  message.msg_iov        = &iov;
+  message.msg_iovlen     = 1;
+  message.msg_control    = control.buffer;
+  message.msg_controllen = sizeof control.buffer;
+
+  auto cmsg = CMSG_FIRSTHDR (&message);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type  = SCM_RIGHTS;
+  cmsg->cmsg_len   = CMSG_LEN (sizeof fds);
+  memcpy (CMSG_DATA (cmsg), fds, sizeof fds);
+
+  return sendmsg (fd, &message, 0) == sizeof length &&
+         writeAll (fd, request.data (), request.length ());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static bool receiveRequest (int fd, int (&fds)[3], std::vector <std::string>& items)
+{
+  uint32_t length {0};
+  iovec iov {&length, sizeof length};
+
+  union
+  {
+    cmsghdr header;
+    char    buffer[CMSG_SPACE (sizeof fds)];
+  } control;
+  memset (&control, 0, sizeof control);
+
+  msghdr message {};
+  message.msg_iov        = &iov;
+  message.msg_iovlen     = 1;
+  message.msg_control    = control.buffer;
+  message.msg_controllen = sizeof control.buffer;
+
+  if (recvmsg (fd, &message, 0) != sizeof length)
+    return false;
+
+  auto cmsg = CMSG_FIRSTHDR (&message);
+  if (! cmsg                            ||
+      cmsg->cmsg_level != SOL_SOCKET    ||
+      cmsg->cmsg_type  != SCM_RIGHTS    ||
+      cmsg->cmsg_len   != CMSG_LEN (sizeof fds))
+    return false;
+
+  memcpy (fds, CMSG_DATA (cmsg), sizeof fds);
+
+  std::string request (length, '\0');
+  if (length > MAX_REQUEST ||
+      ! readAll (fd, &request[0], length))
+    return false;
+
+  std::string::size_type start = 0;
+  std::string::size_type end;
+  while ((end = request.find ('\0', start)) != std::string::npos)
+  {
+    items.push_back (request.substr (start, end - start));
+    start = end + 1;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Adds the files that a configuration file includes, directly or not, to
+// files.  Returns false if an include cannot be located, in which case changes
+// to it would go unnoticed.
+static bool includes (const std::string& rc, std::vector <std::string>& files, int depth = 1)
+{
+  std::vector <std::string> lines;
+  if (depth > 10 ||
+      ! File::read (rc, lines))
+    return depth <= 10;
+
+  auto slash = rc.rfind ('/');
+  auto directory = slash == std::string::npos ? std::string (".") : rc.substr (0, slash);
+
+  for (auto& line : lines)
+  {
+    auto entry = Lexer::trim (line.substr (0, line.find ('#')), " \t");
+    if (entry.compare (0, 8, "include ") &&
+        entry.compare (0, 8, "include\t"))
+      continue;
+
+    auto path = Lexer::trim (entry.substr (8), " \t");
+    if (path[0] == '~')
+    {
+      auto home = getenv ("HOME");
+      path = (home ? home : "") + path.substr (1);
+    }
+    else if (path[0] != '/')
+      path = directory + '/' + path;
+
+    struct stat s;
+    if (stat (path.c_str (), &s) == -1)
+      return false;
+
+    files.push_back (path);
+    if (! includes (path, files, depth + 1))
+      return false;
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Identifies the state of the files a warm Context depends on, so that any
+// change, by a command or by another program, is noticed.  Returns an empty
+// string if the configuration includes a file that cannot be tracked, so that
+// the warm Context is not reused.
+static std::string signature ()
+{
+  auto& context = Context::getContext ();
+  auto& tdb2 = context.tdb2;
+
+  std::vector <std::string> files {context.rc_file._data};
+  if (! includes (context.rc_file._data, files))
+    return "";
+
+  for (auto& file : {tdb2.pending._file._data,
+                     tdb2.pending._file._data + ".journal",
+                     tdb2.completed._file._data,
+                     tdb2.completed._file._data + ".journal",
+                     tdb2.undo._file._data})
+    files.push_back (file);
+
+  std::stringstream out;
+  for (auto& file : files)
+  {
+    struct stat s;
+    if (stat (file.c_str (), &s) == 0)
+      out << s.st_ino  << ' '
+          << s.st_size << ' '
+#if defined (DARWIN)
+          << s.st_mtimespec.tv_sec << '.' << s.st_mtimespec.tv_nsec
+#else
+          << s.st_mtim.tv_sec << '.' << s.st_mtim.tv_nsec
+#endif
+          << '\n';
+    else
+      out << "-\n";
+  }
+
+  return out.str ();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// The environment that selects the configuration, data and time zone.  A
+// relative path also depends on the working directory.
+static std::string environment ()
+{
+  std::string key;
+  bool relative = false;
+  for (auto& name : {"HOME", "TASKRC", "TASKDATA", "TZ"})
+  {
+    auto value = getenv (name);
+    key += value ? value : "-";
+    key += '\n';
+
+    if (value && *value != '/' &&
+        (! strcmp (name, "TASKRC") || ! strcmp (name, "TASKDATA")))
+      relative = true;
+  }
+
+  char cwd[PATH_MAX];
+  if (relative && getcwd (cwd, sizeof cwd))
+    key += cwd;
+
+  return key;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static int runCommand (int argc, const char** argv)
+{
+  int status {0};
+
+  try
+  {
+    status = Context::getContext ().initialize (argc, argv);
+    if (status == 0)
+      status = Context::getContext ().run ();
+  }
+
+  catch (const std::string& error)
+  {
+    std::cerr << error << "\n";
+    status = -1;
+  }
+
+  catch (std::bad_alloc& error)
+  {
+    std::cerr << "Error: Memory allocation failed: " << error.what () << "\n";
+    status = -3;
+  }
+
+  catch (...)
+  {
+    std::cerr << "Unknown error. Please report.\n";
+    status = -2;
+  }
+
+  return status;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Runs one client's command, on the client's own stdin, stdout and stderr, and
+// returns the exit status over the socket.  The warm Context is used unless
+// the command selects another configuration or data location, or the files
+// have changed since they were read, in which case a fresh Context runs the
+// command as a separate process would.
+static void serve (int client, const std::string& warm, const std::string& settings)
+{
+  int fds[3];
+  std::vector <std::string> items;
+  if (! receiveRequest (client, fds, items))
+    return;
+
+  for (int i = 0; i < 3; ++i)
+  {
+    dup2 (fds[i], i);
+    if (fds[i] > 2)
+      close (fds[i]);
+  }
+
+  size_t argc = items.size () > 1 ? strtoul (items[1].c_str (), nullptr, 10) : 0;
+  if (argc == 0 ||
+      items.size () < argc + 2)
+    return;
+
+  // Detach from the daemon's terminal, so that reading the client's does not
+  // stop the process.
+  setsid ();
+
+  if (chdir (items[0].c_str ()) == -1)
+    std::cerr << format ("Could not change to '{1}': {2}", items[0], strerror (errno)) << '\n';
+
+  std::vector <char*> env;
+  for (auto i = argc + 2; i < items.size (); ++i)
+    env.push_back (&items[i][0]);
+  env.push_back (nullptr);
+  environ = env.data ();
+
+  // Hooks that run task are not sent back to this daemon.
+  unsetenv ("TASKSOCKET");
+
+  // Dates are shown in the client's time zone.
+  tzset ();
+
+  std::vector <const char*> argv;
+  for (size_t i = 2; i < argc + 2; ++i)
+    argv.push_back (items[i].c_str ());
+  argv.push_back (nullptr);
+
+  std::string home;
+  File rc;
+  Path data;
+  bool reuse = warm != ""                                        &&
+               environment () == settings                        &&
+               ! CLI2::getOverride ((int) argc, &argv[0], home, rc) &&
+               ! CLI2::getDataLocation ((int) argc, &argv[0], data) &&
+               signature () == warm;
+
+  Context fresh;
+  if (reuse)
+    Context::getContext ().profiler = Profiler ();
+  else
+    Context::setContext (&fresh);
+
+  int32_t status = runCommand ((int) argc, &argv[0]);
+
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (nullptr);
+  writeAll (client, &status, sizeof status);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A worker prepares a Context and reads the data, then waits for a client.
+// It exits without one if the files change, or the daemon goes away, and the
+// daemon starts another.
+static int worker (int listener, int ready)
+{
+  signal (SIGINT,  SIG_DFL);
+  signal (SIGTERM, SIG_DFL);
+  signal (SIGCHLD, SIG_DFL);
+
+  auto& context = Context::getContext ();
+  std::string warm;
+
+  try
+  {
+    context.warmup ("task");
+    warm = signature ();
+    context.tdb2.pending.preload ();
+    context.tdb2.completed.preload ();
+  }
+
+  catch (const std::string& error)
+  {
+    std::cerr << error << "\n";
+    return 1;
+  }
+
+  auto settings = environment ();
+
+  int client = -1;
+  while (client == -1)
+  {
+    pollfd fds[2] {{listener, POLLIN, 0}, {ready, 0, 0}};
+    auto n = poll (fds, 2, 1000);
+    if (n == -1 && errno != EINTR)
+      return 1;
+
+    if (fds[1].revents & (POLLERR | POLLHUP))
+      return 0;
+
+    if (fds[0].revents & POLLIN)
+    {
+      client = accept (listener, nullptr, nullptr);
+      if (client != -1 &&
+          ! trusted (client))
+      {
+        close (client);
+        client = -1;
+      }
+    }
+
+    else if (n == 0 && signature () != warm)
+      return 0;
+  }
+
+  // Let the daemon prepare the next worker.
+  writeAll (ready, "+", 1);
+  close (ready);
+  close (listener);
+
+  fcntl (client, F_SETFD, FD_CLOEXEC);
+  serve (client, warm, settings);
+  close (client);
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Serves commands on a Unix domain socket, until interrupted.  There is always
+// one worker process waiting, with the configuration loaded and the data files
+// parsed, that takes the next command.
+int daemonServe (const std::string& path)
+{
+  if (path == "")
+    throw std::string ("The daemon requires TASKSOCKET to name its socket.");
+
+  int listener = listenOn (path);
+
+  struct sigaction action {};
+  action.sa_handler = stop;
+  sigemptyset (&action.sa_mask);
+  sigaction (SIGINT,  &action, nullptr);
+  sigaction (SIGTERM, &action, nullptr);
+
+  // Workers are not waited for.
+  signal (SIGCHLD, SIG_IGN);
+
+  while (! stopping)
+  {
+    int ready[2];
+    if (pipe (ready) == -1)
+      break;
+
+    auto started = time (nullptr);
+    auto pid = fork ();
+    if (pid == 0)
+    {
+      close (ready[0]);
+      _exit (worker (listener, ready[1]));
+    }
+
+    close (ready[1]);
+
+    // Wait until the worker has a client, or has exited.
+    char byte;
+    ssize_t n = -1;
+    if (pid != -1)
+      while ((n = read (ready[0], &byte, 1)) == -1 &&
+             errno == EINTR                         &&
+             ! stopping)
+        ;
+
+    close (ready[0]);
+
+    // A worker that cannot start is not restarted at full speed.
+    if (n != 1 &&
+        ! stopping &&
+        time (nullptr) - started < 2)
+      sleep (1);
+  }
+
+  close (listener);
+  unlink (path.c_str ());
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sends the command to a daemon listening on the socket, if there is one, and
+// waits for the exit status.  Returns false if no daemon took the command.
+bool daemonForward (const std::string& path, int argc, const char** argv, int& status)
+{
+  int fd = connectTo (path);
+  if (fd == -1)
+    return false;
+
+  char cwd[PATH_MAX];
+  if (! getcwd (cwd, sizeof cwd))
+  {
+    close (fd);
+    return false;
+  }
+
+  std::string request;
+  request += cwd;
+  request += '\0';
+  request += std::to_string (argc);
+  request += '\0';
+
+  for (int i = 0; i < argc; ++i)
+  {
+    request += argv[i];
+    request += '\0';
+  }
+
+  for (auto env = environ; *env; ++env)
+  {
+    request += *env;
+    request += '\0';
+  }
+
+  if (! sendRequest (fd, request))
+  {
+    close (fd);
+    return false;
+  }
+
+  int32_t result;
+  if (readAll (fd, &result, sizeof result))
+    status = result;
+  else
+  {
+    std::cerr << "The daemon did not complete the command.\n";
+    status = -2;
+  }
+
+  close (fd);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
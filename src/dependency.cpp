@@ -39,33 +39,16 @@
 ////////////////////////////////////////////////////////////////////////////////
 std::vector <Task> dependencyGetBlocked (const Task& task)
 {
-  auto uuid = task.get ("uuid");
-
-  std::vector <Task> blocked;
-  for (auto& it : Context::getContext ().tdb2.pending.get_tasks ())
-    if (it.getStatus () != Task::completed &&
-        it.getStatus () != Task::deleted   &&
-        it.has ("depends")                 &&
-        it.get ("depends").find (uuid) != std::string::npos)
-      blocked.push_back (it);
-
-  return blocked;
+  return Context::getContext ().tdb2.pending.dependents (task.get ("uuid"));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 std::vector <Task> dependencyGetBlocking (const Task& task)
 {
-  auto depends = task.get ("depends");
+  if (! task.has ("depends"))
+    return std::vector <Task> ();
 
-  std::vector <Task> blocking;
-  if (depends != "")
-    for (auto& it : Context::getContext ().tdb2.pending.get_tasks ())
-      if (it.getStatus () != Task::completed &&
-          it.getStatus () != Task::deleted   &&
-          depends.find (it.get ("uuid")) != std::string::npos)
-        blocking.push_back (it);
-
-  return blocking;
+  return Context::getContext ().tdb2.pending.dependencies (task.getDependencyUUIDs ());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -77,42 +60,51 @@ bool dependencyIsCircular (const Task& task)
   if (task.has ("uuid"))
   {
     auto task_uuid = task.get ("uuid");
+    auto& tdb2 = Context::getContext ().tdb2;
 
-    std::stack <Task> s;
-    s.push (task);
+    std::stack <std::vector <std::string>> s;
+    s.push (task.getDependencyUUIDs ());
 
     std::unordered_set <std::string> visited;
     visited.insert (task_uuid);
 
     while (! s.empty ())
     {
-      Task& current = s.top ();
-      auto deps_current = current.getDependencyUUIDs ();
+      auto deps_current = s.top ();
+      s.pop ();
 
       // This is a basic depth first search that always terminates given the
-      // fact that we do not visit any task twice
-      for (unsigned int i = 0; i < deps_current.size (); i++)
+      // fact that we do not visit any task twice.  Edges come from the pending
+      // dependency graph, and only tasks outside it are looked up.
+      for (auto& dep : deps_current)
       {
-        if (Context::getContext ().tdb2.get (deps_current[i], current))
+        std::vector <std::string> deps_next;
+        std::string current_uuid;
+        Task current;
+
+        if (tdb2.pending.get_dependencies (dep, deps_next))
+          current_uuid = dep;
+        else if (tdb2.get (dep, current))
         {
-          auto current_uuid = current.get ("uuid");
-
-          if (task_uuid == current_uuid)
-          {
-            // Cycle found, initial task reached for the second time!
-            return true;
-          }
-
-          if (visited.find (current_uuid) == visited.end ())
-          {
-            // Push the task to the stack, if it has not been processed yet
-            s.push (current);
-            visited.insert (current_uuid);
-          }
+          current_uuid = current.get ("uuid");
+          deps_next = current.getDependencyUUIDs ();
         }
-      }
+        else
+          continue;
 
-      s.pop ();
+        if (task_uuid == current_uuid)
+        {
+          // Cycle found, initial task reached for the second time!
+          return true;
+        }
+
+        if (visited.find (current_uuid) == visited.end ())
+        {
+          // Push the dependencies to the stack, if not processed yet
+          s.push (deps_next);
+          visited.insert (current_uuid);
+        }
+      }
     }
   }
 
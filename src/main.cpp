@@ -28,7 +28,9 @@
 #include <iostream>
 #include <new>
 #include <cstring>
+#include <cstdlib>
 #include <Context.h>
+#include <main.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 int main (int argc, const char** argv)
@@ -43,8 +45,30 @@ int main (int argc, const char** argv)
   {
     std::cout << VERSION << "\n";
   }
+
+  // Serve commands on the socket named by $TASKSOCKET.
+  else if (argc == 2 && !strcmp (argv[1], "--daemon"))
+  {
+    auto socket = getenv ("TASKSOCKET");
+    try
+    {
+      status = daemonServe (socket ? socket : "");
+    }
+
+    catch (const std::string& error)
+    {
+      std::cerr << error << "\n";
+      status = -1;
+    }
+  }
+
   else
   {
+    // A running daemon takes the command, if there is one.
+    auto socket = getenv ("TASKSOCKET");
+    if (socket && daemonForward (socket, argc, argv, status))
+      return status;
+
     try
     {
       status = Context::getContext ().initialize (argc, argv);
@@ -58,6 +58,10 @@ std::string colorizeFootnote (const std::string&);
 std::string colorizeError (const std::string&);
 std::string colorizeDebug (const std::string&);
 
+// daemon.cpp
+int daemonServe (const std::string&);
+bool daemonForward (const std::string&, int, const char**, int&);
+
 // dependency.cpp
 std::vector <Task> dependencyGetBlocked (const Task&);
 std::vector <Task> dependencyGetBlocking (const Task&);
@@ -81,7 +85,7 @@ std::string onProjectChange (Task&, Task&);
 std::string onExpiration (Task&);
 
 // sort.cpp
-void sort_tasks (std::vector <Task>&, std::vector <int>&, const std::string&);
+void sort_tasks (std::vector <Task>&, std::vector <int>&, const std::string&, size_t limit = 0);
 void sort_projects (std::list <std::pair <std::string, int>>& sorted, std::map <std::string, int>& allProjects);
 void sort_projects (std::list <std::pair <std::string, int>>& sorted, std::map <std::string, bool>& allProjects);
 
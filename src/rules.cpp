@@ -27,13 +27,33 @@
 #include <cmake.h>
 #include <stdlib.h>
 #include <Context.h>
-#include <Datetime.h>
 #include <shared.h>
 #include <main.h>
 
 static std::map <std::string, Color> gsColor;
 static std::vector <std::string> gsPrecedence;
-static Datetime now;
+
+// A color rule, compiled from its name.  'name' and 'value' hold the tag,
+// project, keyword or UDA name and value the rule matches, if any.
+struct ColorRule
+{
+  enum class Kind { blocked, blocking, tagged, active, scheduled, until,
+                    project_none, tag_none, due, due_today, overdue,
+                    recurring, completed, deleted, tag, project, keyword,
+                    uda, uda_value };
+
+  Kind        kind;
+  Color       color;
+  std::string name;
+  std::string value;
+};
+
+// The nontrivial rules in gsPrecedence, in the order they are applied.
+static std::vector <ColorRule> gsRules;
+static bool gsMerge     {false};
+static bool gsSensitive {true};
+
+static void compileColorRules ();
 
 ////////////////////////////////////////////////////////////////////////////////
 void initializeColorRules ()
@@ -46,6 +66,7 @@ void initializeColorRules ()
   {
     gsColor.clear ();
     gsPrecedence.clear ();
+    gsRules.clear ();
 
     // Load all the configuration values, filter to only the ones that begin with
     // "color.", then store name/value in gsColor, and name in rules.
@@ -75,6 +96,8 @@ void initializeColorRules ()
       for (auto& r : results)
         gsPrecedence.push_back (r);
     }
+
+    compileColorRules ();
   }
 
   catch (const std::string& e)
@@ -83,6 +106,82 @@ void initializeColorRules ()
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Decodes the rule names once.  The last rule in precedence has the final say,
+// so rules are stored in reverse order, and those with no color are dropped.
+static void compileColorRules ()
+{
+  static const std::map <std::string, ColorRule::Kind> fixed =
+  {
+    {"color.blocked",      ColorRule::Kind::blocked},
+    {"color.blocking",     ColorRule::Kind::blocking},
+    {"color.tagged",       ColorRule::Kind::tagged},
+    {"color.active",       ColorRule::Kind::active},
+    {"color.scheduled",    ColorRule::Kind::scheduled},
+    {"color.until",        ColorRule::Kind::until},
+    {"color.project.none", ColorRule::Kind::project_none},
+    {"color.tag.none",     ColorRule::Kind::tag_none},
+    {"color.due",          ColorRule::Kind::due},
+    {"color.due.today",    ColorRule::Kind::due_today},
+    {"color.overdue",      ColorRule::Kind::overdue},
+    {"color.recurring",    ColorRule::Kind::recurring},
+    {"color.completed",    ColorRule::Kind::completed},
+    {"color.deleted",      ColorRule::Kind::deleted},
+  };
+
+  for (auto r = gsPrecedence.rbegin (); r != gsPrecedence.rend (); ++r)
+  {
+    ColorRule rule;
+    rule.color = gsColor[*r];
+    if (! rule.color.nontrivial ())
+      continue;
+
+    auto kind = fixed.find (*r);
+    if (kind != fixed.end ())
+      rule.kind = kind->second;
+
+    // Wildcards
+    else if (! r->compare (0, 10, "color.tag.", 10))
+    {
+      rule.kind = ColorRule::Kind::tag;
+      rule.name = r->substr (10);
+    }
+    else if (! r->compare (0, 14, "color.project.", 14))
+    {
+      rule.kind = ColorRule::Kind::project;
+      rule.name = r->substr (14);
+    }
+    else if (! r->compare (0, 14, "color.keyword.", 14))
+    {
+      rule.kind = ColorRule::Kind::keyword;
+      rule.name = r->substr (14);
+    }
+    else if (! r->compare (0, 10, "color.uda.", 10))
+    {
+      // Is the rule color.uda.name.value or color.uda.name?
+      auto pos = r->find ('.', 10);
+      if (pos == std::string::npos)
+      {
+        rule.kind = ColorRule::Kind::uda;
+        rule.name = r->substr (10);
+      }
+      else
+      {
+        rule.kind = ColorRule::Kind::uda_value;
+        rule.name = r->substr (10, pos - 10);
+        rule.value = r->substr (pos + 1);
+      }
+    }
+    else
+      continue;
+
+    gsRules.push_back (rule);
+  }
+
+  gsMerge     = Context::getContext ().config.getBoolean ("rule.color.merge");
+  gsSensitive = Context::getContext ().config.getBoolean ("search.case.sensitive");
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 static void applyColor (const Color& base, Color& c, bool merge)
 {
@@ -125,7 +224,7 @@ static void colorizeActive (Task& task, const Color& base, Color& c, bool merge)
 static void colorizeScheduled (Task& task, const Color& base, Color& c, bool merge)
 {
   if (task.has ("scheduled") &&
-      Datetime (task.get_date ("scheduled")) <= now)
+      task.get_date ("scheduled") <= Context::getContext ().time_context.get ().now)
     applyColor (base, c, merge);
 }
 
@@ -137,24 +236,21 @@ static void colorizeUntil (Task& task, const Color& base, Color& c, bool merge)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void colorizeTag (Task& task, const std::string& rule, const Color& base, Color& c, bool merge)
+static void colorizeTag (Task& task, const std::string& tag, const Color& base, Color& c, bool merge)
 {
-  if (task.hasTag (rule.substr (10)))
+  if (task.hasTag (tag))
     applyColor (base, c, merge);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void colorizeProject (Task& task, const std::string& rule, const Color& base, Color& c, bool merge)
+static void colorizeProject (Task& task, const std::string& name, const Color& base, Color& c, bool merge)
 {
-  // Observe the case sensitivity setting.
-  bool sensitive = Context::getContext ().config.getBoolean ("search.case.sensitive");
+  auto& project = task.get_ref ("project");
 
-  auto project = task.get ("project");
-  auto rule_trunc = rule.substr (14);
-
-  // Match project names leftmost.
-  if (rule_trunc.length () <= project.length ())
-    if (compare (rule_trunc, project.substr (0, rule_trunc.length ()), sensitive))
+  // Match project names leftmost, observing the case sensitivity setting.
+  if (name.length () <= project.length ())
+    if (gsSensitive ? ! project.compare (0, name.length (), name)
+                    : compare (name, project.substr (0, name.length ()), false))
       applyColor (base, c, merge);
 }
 
@@ -173,14 +269,14 @@ static void colorizeTagNone (Task& task, const Color& base, Color& c, bool merge
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void colorizeKeyword (Task& task, const std::string& rule, const Color& base, Color& c, bool merge)
+static void colorizeKeyword (Task& task, const std::string& keyword, const Color& base, Color& c, bool merge)
 {
   // Observe the case sensitivity setting.
-  auto sensitive = Context::getContext ().config.getBoolean ("search.case.sensitive");
+  auto sensitive = gsSensitive;
 
   // The easiest thing to check is the description, because it is just one
   // attribute.
-  if (find (task.get ("description"), rule.substr (14), sensitive) != std::string::npos)
+  if (find (task.get_ref ("description"), keyword, sensitive) != std::string::npos)
     applyColor (base, c, merge);
 
   // Failing the description check, look at all annotations, returning on the
@@ -190,7 +286,7 @@ static void colorizeKeyword (Task& task, const std::string& rule, const Color& b
     for (const auto& att : task.data)
     {
       if (! att.first.compare (0, 11, "annotation_", 11) &&
-          find (att.second, rule.substr (14), sensitive) != std::string::npos)
+          find (att.second, keyword, sensitive) != std::string::npos)
       {
         applyColor (base, c, merge);
         return;
@@ -200,23 +296,18 @@ static void colorizeKeyword (Task& task, const std::string& rule, const Color& b
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-static void colorizeUDA (Task& task, const std::string& rule, const Color& base, Color& c, bool merge)
+static void colorizeUDA (Task& task, const std::string& uda, const Color& base, Color& c, bool merge)
 {
-  // Is the rule color.uda.name.value or color.uda.name?
-  auto pos = rule.find ('.', 10);
-  if (pos == std::string::npos)
-  {
-    if (task.has (rule.substr (10)))
-      applyColor (base, c, merge);
-  }
-  else
-  {
-    auto uda = rule.substr (10, pos - 10);
-    auto val = rule.substr (pos + 1);
-    if ((val == "none" && ! task.has (uda)) ||
-        task.get (uda) == val)
-      applyColor (base, c, merge);
-  }
+  if (task.has (uda))
+    applyColor (base, c, merge);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+static void colorizeUDAValue (Task& task, const std::string& uda, const std::string& value, const Color& base, Color& c, bool merge)
+{
+  if ((value == "none" && ! task.has (uda)) ||
+      task.get_ref (uda) == value)
+    applyColor (base, c, merge);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -291,40 +382,38 @@ void autoColorize (Task& task, Color& c)
     return;
   }
 
-  auto merge = Context::getContext ().config.getBoolean ("rule.color.merge");
+  // Nothing else to do, if no rule has a color.
+  if (gsRules.empty ())
+    return;
 
   // Note: c already contains colors specifically assigned via command.
-  // Note: These rules form a hierarchy - the last rule is King, hence the
-  //       reverse iterator.
-
-  for (auto r = gsPrecedence.rbegin (); r != gsPrecedence.rend (); ++r)
+  auto merge = gsMerge;
+  for (auto& rule : gsRules)
   {
-    Color base = gsColor[*r];
-    if (base.nontrivial ())
+    auto& base = rule.color;
+    switch (rule.kind)
     {
-           if (*r == "color.blocked")                      colorizeBlocked      (task, base, c, merge);
-      else if (*r == "color.blocking")                     colorizeBlocking     (task, base, c, merge);
-      else if (*r == "color.tagged")                       colorizeTagged       (task, base, c, merge);
-      else if (*r == "color.active")                       colorizeActive       (task, base, c, merge);
-      else if (*r == "color.scheduled")                    colorizeScheduled    (task, base, c, merge);
-      else if (*r == "color.until")                        colorizeUntil        (task, base, c, merge);
-      else if (*r == "color.project.none")                 colorizeProjectNone  (task, base, c, merge);
-      else if (*r == "color.tag.none")                     colorizeTagNone      (task, base, c, merge);
-      else if (*r == "color.due")                          colorizeDue          (task, base, c, merge);
-      else if (*r == "color.due.today")                    colorizeDueToday     (task, base, c, merge);
-      else if (*r == "color.overdue")                      colorizeOverdue      (task, base, c, merge);
-      else if (*r == "color.recurring")                    colorizeRecurring    (task, base, c, merge);
-      else if (*r == "color.completed")                    colorizeCompleted    (task, base, c, merge);
-      else if (*r == "color.deleted")                      colorizeDeleted      (task, base, c, merge);
-
-      // Wildcards
-      else if (! r->compare (0, 10, "color.tag.", 10))     colorizeTag          (task, *r, base, c, merge);
-      else if (! r->compare (0, 14, "color.project.", 14)) colorizeProject      (task, *r, base, c, merge);
-      else if (! r->compare (0, 14, "color.keyword.", 14)) colorizeKeyword      (task, *r, base, c, merge);
-      else if (! r->compare (0, 10, "color.uda.", 10))     colorizeUDA          (task, *r, base, c, merge);
+    case ColorRule::Kind::blocked:      colorizeBlocked     (task, base, c, merge);                         break;
+    case ColorRule::Kind::blocking:     colorizeBlocking    (task, base, c, merge);                         break;
+    case ColorRule::Kind::tagged:       colorizeTagged      (task, base, c, merge);                         break;
+    case ColorRule::Kind::active:       colorizeActive      (task, base, c, merge);                         break;
+    case ColorRule::Kind::scheduled:    colorizeScheduled   (task, base, c, merge);                         break;
+    case ColorRule::Kind::until:        colorizeUntil       (task, base, c, merge);                         break;
+    case ColorRule::Kind::project_none: colorizeProjectNone (task, base, c, merge);                         break;
+    case ColorRule::Kind::tag_none:     colorizeTagNone     (task, base, c, merge);                         break;
+    case ColorRule::Kind::due:          colorizeDue         (task, base, c, merge);                         break;
+    case ColorRule::Kind::due_today:    colorizeDueToday    (task, base, c, merge);                         break;
+    case ColorRule::Kind::overdue:      colorizeOverdue     (task, base, c, merge);                         break;
+    case ColorRule::Kind::recurring:    colorizeRecurring   (task, base, c, merge);                         break;
+    case ColorRule::Kind::completed:    colorizeCompleted   (task, base, c, merge);                         break;
+    case ColorRule::Kind::deleted:      colorizeDeleted     (task, base, c, merge);                         break;
+    case ColorRule::Kind::tag:          colorizeTag         (task, rule.name, base, c, merge);              break;
+    case ColorRule::Kind::project:      colorizeProject     (task, rule.name, base, c, merge);              break;
+    case ColorRule::Kind::keyword:      colorizeKeyword     (task, rule.name, base, c, merge);              break;
+    case ColorRule::Kind::uda:          colorizeUDA         (task, rule.name, base, c, merge);              break;
+    case ColorRule::Kind::uda_value:    colorizeUDAValue    (task, rule.name, rule.value, base, c, merge); break;
     }
   }
-
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -26,6 +26,8 @@
 
 #include <cmake.h>
 #include <algorithm>
+#include <numeric>
+#include <thread>
 #include <vector>
 #include <list>
 #include <map>
@@ -38,27 +40,128 @@
 #include <util.h>
 #include <format.h>
 
-static std::vector <Task>* global_data = nullptr;
-static std::vector <std::string> global_keys;
-static bool sort_compare (int, int);
+// Smallest number of tasks worth handing to a thread.
+static const size_t SORT_CHUNK = 8192;
+
+// A decomposed sort key.  Every key is reduced to a number per task, so that
+// comparisons never look at the task again.
+struct SortKey
+{
+  enum class Kind { urgency, id, string, date, depends, duration, numeric, ordered, udastring, ignored };
+
+  std::string field;
+  Kind        kind;
+  bool        ascending;
+};
+
+// The extracted value of one key for one task.  Empty values of dates and
+// string UDAs sort last, regardless of direction.
+struct SortValue
+{
+  double number;
+  bool   empty;
+};
+
+static std::vector <SortKey> sort_keys (const std::string&);
+static void sort_extract (std::vector <Task>&, const std::vector <int>&, const SortKey&, size_t, size_t, std::vector <SortValue>&);
 
 ////////////////////////////////////////////////////////////////////////////////
+// With a nonzero limit, only the first 'limit' entries of order are sorted, and
+// the remainder is left in unspecified order.
 void sort_tasks (
   std::vector <Task>& data,
   std::vector <int>& order,
-  const std::string& keys)
+  const std::string& keys,
+  size_t limit)
 {
-  Timer timer;
-  global_data = &data;
-
-  // Split the key defs.
-  global_keys = split (keys, ',');
+  Profiler::Scope scope ("sort");
 
   // Only sort if necessary.
-  if (order.size ())
-    std::stable_sort (order.begin (), order.end (), sort_compare);
+  if (order.size () > 1)
+  {
+    auto spec = sort_keys (keys);
+
+    // One row of values per task, one column per key.
+    auto count = order.size ();
+    auto width = spec.size ();
+    std::vector <SortValue> values (count * width);
+    for (size_t k = 0; k < width; ++k)
+      sort_extract (data, order, spec[k], k, width, values);
+
+    auto compare = [&] (size_t left, size_t right)
+    {
+      auto l = &values[left * width];
+      auto r = &values[right * width];
+      for (size_t k = 0; k < width; ++k)
+      {
+        if (l[k].empty != r[k].empty)
+          return r[k].empty;
+
+        if (l[k].number == r[k].number)
+          continue;
+
+        return spec[k].ascending ? (l[k].number < r[k].number)
+                                 : (l[k].number > r[k].number);
+      }
+
+      return false;
+    };
+
+    std::vector <size_t> rows (count);
+    std::iota (rows.begin (), rows.end (), 0);
+
+    // Large reports are sorted in contiguous ranges on several threads, which
+    // are then merged.  Both steps are stable.
+    size_t threads = std::max ((size_t) 1, std::min ((size_t) std::thread::hardware_concurrency (), count / SORT_CHUNK));
+    if (limit && limit < count)
+    {
+      // Only the leading rows are shown, so select them with a bounded heap.
+      // Ties fall back to the original position, which keeps this stable.
+      std::partial_sort (rows.begin (), rows.begin () + limit, rows.end (), [&] (size_t left, size_t right)
+      {
+        if (compare (left, right))
+          return true;
+
+        if (compare (right, left))
+          return false;
 
-  Context::getContext ().time_sort_us += timer.total_us ();
+        return left < right;
+      });
+    }
+    else if (threads == 1)
+      std::stable_sort (rows.begin (), rows.end (), compare);
+    else
+    {
+      std::vector <size_t> bounds;
+      for (size_t t = 0; t <= threads; ++t)
+        bounds.push_back (count * t / threads);
+
+      std::vector <std::thread> pool;
+      for (size_t t = 0; t < threads; ++t)
+        pool.emplace_back ([&, t] ()
+        {
+          std::stable_sort (rows.begin () + bounds[t], rows.begin () + bounds[t + 1], compare);
+        });
+
+      for (auto& thread : pool)
+        thread.join ();
+
+      for (size_t step = 1; step < threads; step *= 2)
+        for (size_t t = 0; t + step < threads; t += 2 * step)
+          std::inplace_merge (rows.begin () + bounds[t],
+                              rows.begin () + bounds[t + step],
+                              rows.begin () + bounds[std::min (t + 2 * step, threads)],
+                              compare);
+    }
+
+    std::vector <int> sorted (count);
+    for (size_t i = 0; i < count; ++i)
+      sorted[i] = order[rows[i]];
+
+    order.swap (sorted);
+  }
+
+  Context::getContext ().profiler.count ("tasks.sorted", (long) (limit && limit < order.size () ? limit : order.size ()));
 }
 
 void sort_projects (
@@ -106,52 +209,23 @@ void sort_projects (
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// Re-implementation, using direct Task access instead of data copies that
-// require re-parsing.
-//
-// Essentially a static implementation of a dynamic operator<.
-static bool sort_compare (int left, int right)
+// Decomposes the sort spec once, and determines how each key is compared.
+static std::vector <SortKey> sort_keys (const std::string& keys)
 {
-  std::string field;
-  bool ascending;
-  bool breakIndicator;
-  Column* column;
-  int left_number;
-  int right_number;
-  float left_real;
-  float right_real;
-
-  for (auto& k : global_keys)
+  std::vector <SortKey> spec;
+  for (auto& k : split (keys, ','))
   {
-    Context::getContext ().decomposeSortField (k, field, ascending, breakIndicator);
+    SortKey key;
+    bool breakIndicator;
+    Context::getContext ().decomposeSortField (k, key.field, key.ascending, breakIndicator);
 
-    // Urgency.
+    auto& field = key.field;
     if (field == "urgency")
-    {
-      left_real  = (*global_data)[left].urgency ();
-      right_real = (*global_data)[right].urgency ();
-
-      if (left_real == right_real)
-        continue;
+      key.kind = SortKey::Kind::urgency;
 
-      return ascending ? (left_real < right_real)
-                       : (left_real > right_real);
-    }
-
-    // Number.
     else if (field == "id")
-    {
-      left_number  = (*global_data)[left].id;
-      right_number = (*global_data)[right].id;
+      key.kind = SortKey::Kind::id;
 
-      if (left_number == right_number)
-        continue;
-
-      return ascending ? (left_number < right_number)
-                       : (left_number > right_number);
-    }
-
-    // String.
     else if (field == "description" ||
              field == "project"     ||
              field == "status"      ||
@@ -160,18 +234,8 @@ static bool sort_compare (int left, int right)
              field == "parent"      ||
              field == "imask"       ||
              field == "mask")
-    {
-      auto left_string  = (*global_data)[left].get_ref  (field);
-      auto right_string = (*global_data)[right].get_ref (field);
-
-      if (left_string == right_string)
-        continue;
-
-      return ascending ? (left_string < right_string)
-                       : (left_string > right_string);
-    }
+      key.kind = SortKey::Kind::string;
 
-    // Due Date.
     else if (field == "due"      ||
              field == "end"      ||
              field == "entry"    ||
@@ -180,146 +244,144 @@ static bool sort_compare (int left, int right)
              field == "wait"     ||
              field == "modified" ||
              field == "scheduled")
-    {
-      auto left_string  = (*global_data)[left].get_ref  (field);
-      auto right_string = (*global_data)[right].get_ref (field);
-
-      if (left_string != "" && right_string == "")
-        return true;
-
-      if (left_string == "" && right_string != "")
-        return false;
-
-      if (left_string == right_string)
-        continue;
-
-      return ascending ? (left_string < right_string)
-                       : (left_string > right_string);
-    }
+      key.kind = SortKey::Kind::date;
 
-    // Depends string.
     else if (field == "depends")
-    {
-      // Raw data is a comma-separated list of uuids
-      auto left_string  = (*global_data)[left].get_ref  (field);
-      auto right_string = (*global_data)[right].get_ref (field);
-
-      if (left_string == right_string)
-        continue;
-
-      if (left_string == "" && right_string != "")
-        return ascending;
-
-      if (left_string != "" && right_string == "")
-        return !ascending;
+      key.kind = SortKey::Kind::depends;
 
-      // Sort on the first dependency.
-      left_number  = Context::getContext ().tdb2.id (left_string.substr (0, 36));
-      right_number = Context::getContext ().tdb2.id (right_string.substr (0, 36));
+    else if (field == "recur")
+      key.kind = SortKey::Kind::duration;
 
-      if (left_number == right_number)
-        continue;
+    // UDAs.
+    else
+    {
+      auto column = Context::getContext ().columns.find (field);
+      if (column == Context::getContext ().columns.end () ||
+          column->second == nullptr)
+        throw format ("The '{1}' column is not a valid sort field.", field);
 
-      return ascending ? (left_number < right_number)
-                       : (left_number > right_number);
+      auto type = column->second->type ();
+      if (type == "numeric")
+        key.kind = SortKey::Kind::numeric;
+      else if (type == "string")
+        key.kind = Task::customOrder.find (field) != Task::customOrder.end ()
+                   ? SortKey::Kind::ordered
+                   : SortKey::Kind::udastring;
+      else if (type == "date")
+        key.kind = SortKey::Kind::date;
+      else if (type == "duration")
+        key.kind = SortKey::Kind::duration;
+      else
+        key.kind = SortKey::Kind::ignored;
     }
 
-    // Duration.
-    else if (field == "recur")
-    {
-      auto left_string  = (*global_data)[left].get_ref  (field);
-      auto right_string = (*global_data)[right].get_ref (field);
+    spec.push_back (key);
+  }
 
-      if (left_string == right_string)
-        continue;
+  return spec;
+}
 
-      Duration left_duration (left_string);
-      Duration right_duration (right_string);
-      return ascending ? (left_duration < right_duration)
-                       : (left_duration > right_duration);
-    }
+////////////////////////////////////////////////////////////////////////////////
+// Fills in one column of the values table, with the typed value of a key for
+// each task.  Strings are replaced by their rank among the values present,
+// which preserves their byte-wise order.
+static void sort_extract (
+  std::vector <Task>& data,
+  const std::vector <int>& order,
+  const SortKey& key,
+  size_t column,
+  size_t width,
+  std::vector <SortValue>& values)
+{
+  auto count = order.size ();
+  auto value = [&] (size_t row) -> SortValue& { return values[row * width + column]; };
 
-    // UDAs.
-    else if ((column = Context::getContext ().columns[field]) != nullptr)
+  switch (key.kind)
+  {
+  case SortKey::Kind::urgency:
+    Task::urgency (data);
+    for (size_t i = 0; i < count; ++i)
+      value (i) = {data[order[i]].urgency (), false};
+    break;
+
+  case SortKey::Kind::id:
+    for (size_t i = 0; i < count; ++i)
+      value (i) = {(double) data[order[i]].id, false};
+    break;
+
+  case SortKey::Kind::string:
+  case SortKey::Kind::udastring:
     {
-      std::string type = column->type ();
-      if (type == "numeric")
-      {
-        auto left_real  = strtof (((*global_data)[left].get_ref  (field)).c_str (), nullptr);
-        auto right_real = strtof (((*global_data)[right].get_ref (field)).c_str (), nullptr);
+      std::vector <const std::string*> strings (count);
+      for (size_t i = 0; i < count; ++i)
+        strings[i] = &data[order[i]].get_ref (key.field);
 
-        if (left_real == right_real)
-          continue;
-
-        return ascending ? (left_real < right_real)
-                         : (left_real > right_real);
-      }
-      else if (type == "string")
+      std::vector <size_t> rows (count);
+      std::iota (rows.begin (), rows.end (), 0);
+      std::sort (rows.begin (), rows.end (), [&] (size_t left, size_t right)
       {
-        auto left_string = (*global_data)[left].get_ref (field);
-        auto right_string = (*global_data)[right].get_ref (field);
+        return *strings[left] < *strings[right];
+      });
 
-        if (left_string == right_string)
-          continue;
+      // Without a custom order, empty UDA values are unconditionally last.
+      double rank = 0;
+      for (size_t i = 0; i < count; ++i)
+      {
+        if (i && *strings[rows[i]] != *strings[rows[i - 1]])
+          ++rank;
 
-        // UDAs of the type string can have custom sort orders, which need to be considered.
-        auto order = Task::customOrder.find (field);
-        if (order != Task::customOrder.end ())
-        {
-          // Guaranteed to be found, because of ColUDA::validate ().
-          auto posLeft  = std::find (order->second.begin (), order->second.end (), left_string);
-          auto posRight = std::find (order->second.begin (), order->second.end (), right_string);
-          return ascending ? (posLeft < posRight) : (posLeft > posRight);
-        }
-        else
-        {
-          // Empty values are unconditionally last, if no custom order was specified.
-          if (left_string == "")
-            return false;
-          else if (right_string == "")
-            return true;
-
-          return ascending ? (left_string < right_string)
-                           : (left_string > right_string);
-        }
+        value (rows[i]) = {rank, key.kind == SortKey::Kind::udastring && strings[rows[i]]->empty ()};
       }
+    }
+    break;
 
-      else if (type == "date")
+  case SortKey::Kind::ordered:
+    {
+      // Guaranteed to be found, because of ColUDA::validate ().
+      auto& custom = Task::customOrder[key.field];
+      for (size_t i = 0; i < count; ++i)
       {
-        auto left_string  = (*global_data)[left].get_ref  (field);
-        auto right_string = (*global_data)[right].get_ref (field);
-
-        if (left_string != "" && right_string == "")
-          return true;
+        auto position = std::find (custom.begin (), custom.end (), data[order[i]].get_ref (key.field));
+        value (i) = {(double) (position - custom.begin ()), false};
+      }
+    }
+    break;
 
-        if (left_string == "" && right_string != "")
-          return false;
+  case SortKey::Kind::date:
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto& epoch = data[order[i]].get_ref (key.field);
+      value (i) = {(double) strtoll (epoch.c_str (), nullptr, 10), epoch == ""};
+    }
+    break;
 
-        if (left_string == right_string)
-          continue;
+  case SortKey::Kind::depends:
+    // Sort on the first dependency, with no dependencies first.
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto& depends = data[order[i]].get_ref (key.field);
+      value (i) = {depends == "" ? -1.0 : (double) Context::getContext ().tdb2.id (depends.substr (0, 36)), false};
+    }
+    break;
 
-        return ascending ? (left_string < right_string)
-                         : (left_string > right_string);
-      }
-      else if (type == "duration")
-      {
-        auto left_string  = (*global_data)[left].get_ref  (field);
-        auto right_string = (*global_data)[right].get_ref (field);
+  case SortKey::Kind::duration:
+    for (size_t i = 0; i < count; ++i)
+    {
+      auto& duration = data[order[i]].get_ref (key.field);
+      value (i) = {duration == "" ? 0.0 : (double) Duration (duration).toTime_t (), false};
+    }
+    break;
 
-        if (left_string == right_string)
-          continue;
+  case SortKey::Kind::numeric:
+    for (size_t i = 0; i < count; ++i)
+      value (i) = {strtof (data[order[i]].get_ref (key.field).c_str (), nullptr), false};
+    break;
 
-        Duration left_duration (left_string);
-        Duration right_duration (right_string);
-        return ascending ? (left_duration < right_duration)
-                         : (left_duration > right_duration);
-      }
-    }
-    else
-      throw format ("The '{1}' column is not a valid sort field.", field);
+  case SortKey::Kind::ignored:
+    for (size_t i = 0; i < count; ++i)
+      value (i) = {0.0, false};
+    break;
   }
-
-  return false;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,112 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# https://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Task, TestCase
+
+
+class TestBatch(TestCase):
+
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Task()
+
+    def test_batch_stdin(self):
+        """Verify a batch read from STDIN runs every command"""
+        batch = "add one\n# comment\n\nadd 'two words' project:home\n1 done\n"
+        code, out, err = self.t("batch", input=batch)
+        self.assertIn("Batch ran 3 commands, 0 failed.", err)
+
+        code, out, err = self.t("_get 2.description 2.project")
+        self.assertEqual("two words home\n", out)
+
+        code, out, err = self.t("completed")
+        self.assertIn("one", out)
+
+    def test_batch_ids_stable(self):
+        """Verify IDs in a batch refer to the tasks as numbered at the start"""
+        self.t("add one")
+        self.t("add two")
+        self.t("add three")
+
+        # Run separately, GC after the first command would make 'three' task 2.
+        self.t("batch", input="1 done\n2 modify +tag\n")
+
+        tasks = self.t.export("+tag")
+        self.assertEqual(len(tasks), 1)
+        self.assertEqual(tasks[0]["description"], "two")
+
+    def test_batch_failure(self):
+        """Verify a failed command is reported, and the rest still run"""
+        code, out, err = self.t.runError("batch", input="999 done\nadd one\n")
+        self.assertIn("Batch line 1, status 1: 999 done", err)
+        self.assertIn("Batch line 2, status 0: add one", err)
+        self.assertIn("Batch ran 2 commands, 1 failed.", err)
+
+        code, out, err = self.t("_get 1.description")
+        self.assertEqual("one\n", out)
+
+    def test_batch_override(self):
+        """Verify an override on a batch line is rejected, not ignored"""
+        code, out, err = self.t.runError("batch", input="add one rc.verbose:nothing\nadd two\n")
+        self.assertIn("The override 'rc.verbose:nothing' is not supported on a batch line", err)
+        self.assertIn("Batch ran 2 commands, 1 failed.", err)
+
+        code, out, err = self.t("_ids")
+        self.assertEqual("1\n", out)
+
+    def test_batch_output_order(self):
+        """Verify command output is written in the order the commands run"""
+        self.t("add one")
+        code, out, err = self.t("rc.stream.sample:1 batch", input="_get 1.description\nlist\n_get 1.description\n")
+        first = out.find("one\n")
+        self.assertNotEqual(first, -1)
+        self.assertIn("1 task", out[first:])
+        self.assertTrue(out.endswith("one\n"))
+
+    def test_batch_file(self):
+        """Verify a batch is read from a file"""
+        path = os.path.join(self.t.datadir, "commands")
+        with open(path, "w") as fh:
+            fh.write("add one\nadd two\n")
+
+        code, out, err = self.t("batch " + path)
+        code, out, err = self.t("_ids")
+        self.assertEqual("1\n2\n", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
+
+# vim: ai sts=4 et sw=4 ft=python
@@ -73,6 +73,15 @@ class TestCustomReports(TestCase):
         code, out, err = self.t("foo rc._forcecolor:on rc.report.foo.filter:")
         self.assertIn("[44m", out)
 
+    def test_custom_streamed(self):
+        """Verify that a streamed report sized on a sample lists every task"""
+        self.t("add one project:A")
+        self.t("add a much longer description project:A")
+        code, out, err = self.t("foo rc.stream.sample:1")
+        self.assertIn("one", out)
+        self.assertIn("a much longer description", out)
+        self.assertIn("2 tasks", out)
+
 class TestCustomErrorHandling(TestCase):
     def setUp(self):
         self.t = Task()
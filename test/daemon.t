@@ -0,0 +1,126 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# https://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import subprocess
+import time
+import unittest
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Task, TestCase
+
+
+class TestDaemon(TestCase):
+
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Task()
+        self.t("add one")
+
+        # The daemon is started on the test's data, and commands are sent to
+        # it through TASKSOCKET.
+        socket = os.path.join(self.t.datadir, "daemon.socket")
+        env = self.t.env.copy()
+        env["TASKSOCKET"] = socket
+        self.daemon = subprocess.Popen([self.t.taskw, "--daemon"], env=env)
+
+        for i in range(50):
+            if os.path.exists(socket):
+                break
+            time.sleep(0.1)
+
+        self.t.env["TASKSOCKET"] = socket
+
+    def tearDown(self):
+        """Executed after each test in the class"""
+        self.daemon.terminate()
+        self.daemon.wait()
+
+    def test_daemon_runs_commands(self):
+        """Verify the daemon runs commands and returns their output"""
+        code, out, err = self.t("add two")
+        self.assertIn("Created task 2.", out)
+
+        code, out, err = self.t("_ids")
+        self.assertEqual("1\n2\n", out)
+
+    def test_daemon_exit_status(self):
+        """Verify the daemon returns the exit status of the command"""
+        code, out, err = self.t.runError("999 done")
+        self.assertIn("No tasks specified.", err)
+
+    def test_daemon_external_change(self):
+        """Verify the daemon notices changes made without it"""
+        env = self.t.env.copy()
+        del env["TASKSOCKET"]
+        subprocess.check_call([self.t.taskw, "add", "three"], env=env,
+                              stdout=subprocess.PIPE)
+
+        code, out, err = self.t("count")
+        self.assertEqual("2\n", out)
+
+    def test_daemon_included_change(self):
+        """Verify the daemon notices changes to an included rc file"""
+        included = os.path.join(self.t.datadir, "extra.rc")
+        with open(included, "w") as fh:
+            fh.write("foo=one\n")
+        with open(self.t.taskrc, "a") as fh:
+            fh.write("include " + included + "\n")
+
+        code, out, err = self.t("_get rc.foo")
+        self.assertEqual("one\n", out)
+
+        with open(included, "w") as fh:
+            fh.write("foo=three\n")
+
+        code, out, err = self.t("_get rc.foo")
+        self.assertEqual("three\n", out)
+
+    def test_daemon_shared_directory(self):
+        """Verify the daemon refuses a socket in a directory others can reach"""
+        shared = os.path.join(self.t.datadir, "shared")
+        os.mkdir(shared, 0o755)
+        os.chmod(shared, 0o755)
+
+        env = self.t.env.copy()
+        env["TASKSOCKET"] = os.path.join(shared, "daemon.socket")
+        daemon = subprocess.run([self.t.taskw, "--daemon"], env=env,
+                                stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                                universal_newlines=True, timeout=10)
+        self.assertNotEqual(daemon.returncode, 0)
+        self.assertIn("not accessible to others", daemon.stderr)
+        self.assertFalse(os.path.exists(env["TASKSOCKET"]))
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
+
+# vim: ai sts=4 et sw=4 ft=python
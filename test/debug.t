@@ -28,6 +28,7 @@
 
 import sys
 import os
+import json
 import unittest
 # Ensure python finds the local simpletap module
 sys.path.append(os.path.dirname(os.path.abspath(__file__)))
@@ -86,6 +87,48 @@ class TestDebugMode(TestCase):
         self.assertIn("Perf task", err)
 
 
+class TestProfile(TestCase):
+    def setUp(self):
+        """Executed before each test in the class"""
+        self.t = Task()
+        self.t("add one")
+        self.t("add two")
+
+    def test_profile_stderr(self):
+        """Verify rc.profile:stderr writes a JSON profile"""
+        code, out, err = self.t("list rc.profile=stderr")
+
+        profile = json.loads(err.strip().split("\n")[-1])
+        self.assertEqual(profile["command"], "list")
+        self.assertIn("load", profile["profile"]["phases"])
+        self.assertIn("filter", profile["profile"]["phases"])
+        self.assertGreaterEqual(profile["profile"]["counters"]["filter.tasks"], 2)
+        self.assertEqual(profile["profile"]["scopes"]["name"], "total")
+
+    def test_profile_file(self):
+        """Verify rc.profile appends one JSON profile per command to a file"""
+        path = os.path.join(self.t.datadir, "profile.json")
+        self.t("list rc.profile=" + path)
+        self.t("list rc.profile=" + path)
+
+        with open(path) as fh:
+            lines = fh.read().splitlines()
+
+        self.assertEqual(len(lines), 2)
+        for line in lines:
+            self.assertIn("total_us", json.loads(line)["profile"])
+
+    def test_profile_unwritable(self):
+        """Verify a profile that cannot be written does not fail the command"""
+        path = os.path.join(self.t.datadir, "missing", "profile.json")
+        code, out, err = self.t("add one rc.profile=" + path)
+        self.assertEqual(code, 0)
+        self.assertIn("Could not write the profile to", err)
+
+        code, out, err = self.t("_get 1.description")
+        self.assertEqual("one\n", out)
+
+
 if __name__ == "__main__":
     from simpletap import TAPTestRunner
     unittest.main(testRunner=TAPTestRunner())
@@ -168,6 +168,20 @@ class TestDependencies(TestCase):
         self.assertNotIn("Would you like the dependency chain fixed?", out)
         self.assertIn("Deleted 1 task", out)
 
+    def test_blocked_blocking_tags(self):
+        """Check BLOCKED and BLOCKING follow completion of a dependency"""
+        self.t("add three")
+        self.t("3 modify dep:1,2")
+
+        code, out, err = self.t("+BLOCKED _ids")
+        self.assertEqual("3\n", out)
+        code, out, err = self.t("+BLOCKING _ids")
+        self.assertEqual("1-2\n", out)
+
+        self.t("1 done")
+        code, out, err = self.t("+BLOCKING _ids")
+        self.assertEqual("1\n", out)
+
     @unittest.expectedFailure
     def test_id_range_dep(self):
         """Check that an ID range can be used for deps"""
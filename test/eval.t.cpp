@@ -27,6 +27,7 @@
 #include <cmake.h>
 #include <test.h>
 #include <Eval.h>
+#include <Lexer.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 // A few hard-coded symbols.
@@ -43,7 +44,7 @@ bool get (const std::string& name, Variant& value)
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (52);
+  UnitTest t (58);
 
   // Test the source independently.
   Variant v;
@@ -160,6 +161,43 @@ int main (int, char**)
   t.is (result.type (), Variant::type_duration, "infix '- 2days' --> duration");
   t.is (result.get_duration (), -86400*2,      "infix '- 2days' --> -86400 * 2");
 
+  // Compiled expressions may be evaluated repeatedly.
+  std::vector <std::pair <std::string, Lexer::Type>> tokens;
+  Lexer l ("x and 2 + 3 > 4");
+  std::string token;
+  Lexer::Type type;
+  while (l.token (token, type))
+    tokens.push_back (std::pair <std::string, Lexer::Type> (token, type));
+
+  e.compileExpression (tokens);
+  e.evaluateCompiledExpression (result);
+  t.is (result.type (), Variant::type_boolean, "compiled 'x and 2 + 3 > 4' --> boolean");
+  t.is (result.get_bool (), true,              "compiled 'x and 2 + 3 > 4' --> true");
+
+  e.evaluateCompiledExpression (result);
+  t.is (result.type (), Variant::type_boolean, "compiled 'x and 2 + 3 > 4' again --> boolean");
+  t.is (result.get_bool (), true,              "compiled 'x and 2 + 3 > 4' again --> true");
+
+  try
+  {
+    e.evaluatePostfixExpression ("1 +", result);
+    t.fail ("postfix '1 +' --> error");
+  }
+  catch (const std::string& error)
+  {
+    t.is (error, "The expression could not be evaluated.", "postfix '1 +' --> error");
+  }
+
+  try
+  {
+    e.evaluatePostfixExpression ("1 2", result);
+    t.fail ("postfix '1 2' --> error");
+  }
+  catch (const std::string& error)
+  {
+    t.is (error, "The value is not an expression.", "postfix '1 2' --> error");
+  }
+
   return 0;
 }
 
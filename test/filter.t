@@ -380,6 +380,17 @@ class TestFilterDue(TestCase):
         self.assertNotIn("two", out)
         self.assertIn("three", out)
 
+    def test_due_constant_expression(self):
+        """due filtered against a constant expression, folded once"""
+
+        self.t("add one due:{0}".format(self.just))
+        self.t("add two due:{0}".format(self.almost))
+
+        code, out, err = self.t("list due.before:(now+4d) rc.debug.parser=3")
+        self.assertIn("one", out)
+        self.assertNotIn("two", out)
+        self.assertIn("Eval fold", err)
+
 
 class TestBug1110(TestCase):
     def setUp(self):
@@ -1099,6 +1110,78 @@ class TestBug1915(TestCase):
         self.assertIn("thingB", out)
         self.assertNotIn("thingC", out)
 
+
+class TestFilterReferences(TestCase):
+    @classmethod
+    def setUpClass(cls):
+        """Executed once before any test in the class"""
+        cls.t = Task()
+        cls.t.config("uda.estimate.type", "numeric")
+        cls.t.config("verbose", "nothing")
+
+        cls.t("add one due:2030-01-15 estimate:2")
+        cls.t("add two due:2031-06-01 estimate:5")
+        cls.t("add three")
+
+    def test_date_element(self):
+        """Filter on an element of a date attribute"""
+        code, out, err = self.t("'due.year == 2030' list")
+        self.assertIn("one", out)
+        self.assertNotIn("two", out)
+        self.assertNotIn("three", out)
+
+    def test_numeric_uda(self):
+        """Filter on a numeric UDA, present or not"""
+        code, out, err = self.t("'estimate > 3' list")
+        self.assertNotIn("one", out)
+        self.assertIn("two", out)
+        self.assertNotIn("three", out)
+
+    def test_other_task(self):
+        """Filter referencing another task by ID"""
+        code, out, err = self.t("'description == 2.description' list")
+        self.assertNotIn("one", out)
+        self.assertIn("two", out)
+        self.assertNotIn("three", out)
+
+
+class TestFilterThreads(TestCase):
+    @classmethod
+    def setUpClass(cls):
+        """Executed once before any test in the class"""
+        cls.t = Task()
+        tasks = ['{"uuid":"%08d-0000-0000-0000-000000000000","status":"pending","description":"task %d","project":"%s","entry":"20200101T000000Z"}'
+                 % (n, n, "A" if n % 3 else "B") for n in range(3000)]
+        cls.t("import -", input="[" + ",".join(tasks) + "]")
+
+    def test_same_matches(self):
+        """Concurrent filtering matches the same tasks as a single thread"""
+        code, serial, err = self.t("rc.filter.threads:1 project:A _uuids")
+        code, parallel, err = self.t("rc.filter.threads:4 project:A _uuids")
+        self.assertEqual(len(serial.split()), 2000)
+        self.assertEqual(serial, parallel)
+
+    def test_same_regex_matches(self):
+        """Concurrent filtering with a regex matches as a single thread"""
+        code, serial, err = self.t("rc.regex:on rc.filter.threads:1 project:A description~'k.1+$' _uuids")
+        code, parallel, err = self.t("rc.regex:on rc.filter.threads:4 project:A description~'k.1+$' _uuids")
+        self.assertEqual(len(serial.split()), 3)
+        self.assertEqual(serial, parallel)
+
+    def test_dates_parallel(self):
+        """Filters comparing dates are evaluated on several threads"""
+        code, serial, err = self.t("rc.filter.threads:1 project:B entry.before:now 'entry.month == 1' _uuids")
+        code, parallel, err = self.t("rc.debug:1 rc.filter.threads:4 project:B entry.before:now 'entry.month == 1' _uuids")
+        self.assertEqual(len(serial.split()), 1000)
+        self.assertEqual(serial, parallel)
+        self.assertIn("on 4 threads", err)
+
+    def test_virtual_tags_serial(self):
+        """Filters on virtual tags are evaluated by a single thread"""
+        code, out, err = self.t("rc.debug:1 rc.filter.threads:4 project:B +PENDING count")
+        self.assertEqual(out.strip(), "1000")
+        self.assertNotIn("threads", err)
+
 if __name__ == "__main__":
     from simpletap import TAPTestRunner
     unittest.main(testRunner=TAPTestRunner())
@@ -0,0 +1,116 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# https://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Task, TestCase
+
+
+class TestIndex(TestCase):
+    def setUp(self):
+        self.t = Task()
+        self.t("add one")
+        self.t("add two")
+        code, out, err = self.t("_get 1.uuid")
+        self.uuid = out.strip()
+        self.t("1 done")
+
+        # GC moves the task to completed.data, then a full load indexes it.
+        self.t("list")
+        self.t("all")
+        self.completed = os.path.join(self.t.datadir, "completed.data")
+
+    def test_index_created(self):
+        """Index is written when completed.data is loaded"""
+        self.assertTrue(os.path.exists(self.completed + ".index"))
+
+    def test_index_mode(self):
+        """Index has the permissions of completed.data"""
+        os.chmod(self.completed, 0o640)
+        os.remove(self.completed + ".index")
+
+        self.t("all")
+        self.assertEqual(os.stat(self.completed + ".index").st_mode & 0o777, 0o640)
+
+    def test_index_uuid(self):
+        """Completed task found by UUID via the index"""
+        code, out, err = self.t("{0} info rc.debug=1".format(self.uuid))
+        self.assertIn("one", out)
+        self.assertIn("TF2::get_tasks 1 of 1 tasks by UUID", err)
+
+    def test_index_short_uuid(self):
+        """Completed task found by short UUID via the index"""
+        code, out, err = self.t("{0} info".format(self.uuid[:8]))
+        self.assertIn("one", out)
+
+    def test_index_modify(self):
+        """Completed task modified by UUID via the index"""
+        self.t("{0} modify three".format(self.uuid))
+        code, out, err = self.t("{0} info".format(self.uuid))
+        self.assertIn("three", out)
+
+        code, out, err = self.t("all")
+        self.assertIn("three", out)
+        self.assertIn("two", out)
+
+    def test_index_end(self):
+        """Completed task found by end date via the index"""
+        code, out, err = self.t("end.after:yesterday info rc.debug=1")
+        self.assertIn("one", out)
+        self.assertIn("TF2::get_tasks 1 of 1 blocks by end", err)
+
+        code, out, err = self.t.runError("end.before:yesterday info")
+        self.assertIn("No matches.", err)
+
+    def test_index_stale(self):
+        """External changes to completed.data invalidate the index"""
+        with open(self.completed) as fh:
+            data = fh.read()
+        with open(self.completed, "w") as fh:
+            fh.write(data.replace("description:\"one\"",
+                                  "description:\"eleven\""))
+
+        code, out, err = self.t("{0} info".format(self.uuid))
+        self.assertIn("eleven", out)
+
+    def test_index_off(self):
+        """No index is used with rc.index=0"""
+        code, out, err = self.t("{0} info rc.index=0 rc.debug=1".format(self.uuid))
+        self.assertIn("one", out)
+        self.assertNotIn("TF2::get_tasks", err)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
+
+# vim: ai sts=4 et sw=4 ft=python
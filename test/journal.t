@@ -0,0 +1,127 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# https://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Task, TestCase
+
+
+class TestJournal(TestCase):
+    def setUp(self):
+        self.t = Task()
+        self.t.config("data.journal", "1")
+        self.t("add one")
+        self.t("add two")
+        self.pending = os.path.join(self.t.datadir, "pending.data")
+        self.journal = self.pending + ".journal"
+
+    def read(self, path):
+        with open(path) as fh:
+            return fh.read()
+
+    def test_journal_modify(self):
+        """Modifications go to the journal, not pending.data"""
+        self.t("1 modify three")
+        self.assertTrue(os.path.exists(self.journal))
+        self.assertIn("description:\"one\"", self.read(self.pending))
+        self.assertIn("description:\"three\"", self.read(self.journal))
+
+        code, out, err = self.t("list")
+        self.assertRegexpMatches(out, "1\s+three")
+        self.assertRegexpMatches(out, "2\s+two")
+
+    def test_journal_add(self):
+        """Additions go to an active journal"""
+        self.t("1 modify three")
+        self.t("add four")
+        self.assertNotIn("four", self.read(self.pending))
+
+        code, out, err = self.t("list")
+        self.assertRegexpMatches(out, "3\s+four")
+
+    def test_journal_done(self):
+        """Completed tasks leave pending.data through the journal"""
+        self.t("1 done")
+        code, out, err = self.t("list")
+        self.assertNotIn("one", out)
+        self.assertRegexpMatches(out, "1\s+two")
+
+        code, out, err = self.t("completed")
+        self.assertIn("one", out)
+
+    def test_journal_gc(self):
+        """Tasks moved by GC are journaled, not rewritten"""
+        self.t("1 done")
+        self.t("list")
+        self.assertIn("one", self.read(self.pending))
+        self.assertIn("\ndel ", self.read(self.journal))
+
+        completed = os.path.join(self.t.datadir, "completed.data")
+        self.assertIn("description:\"one\"", self.read(completed + ".journal"))
+
+    def test_journal_undo(self):
+        """Undo discards the journal it applied"""
+        self.t("1 modify three")
+        self.t("undo", input="y\n")
+        self.assertFalse(os.path.exists(self.journal))
+
+        code, out, err = self.t("list")
+        self.assertRegexpMatches(out, "1\s+one")
+
+    def test_journal_compact(self):
+        """Disabling the journal compacts it into pending.data"""
+        self.t("1 modify three")
+        self.t("2 modify four rc.data.journal=0")
+        self.assertFalse(os.path.exists(self.journal))
+        self.assertIn("description:\"three\"", self.read(self.pending))
+        self.assertIn("description:\"four\"", self.read(self.pending))
+
+    def test_journal_stale(self):
+        """A journal survives another program changing pending.data"""
+        self.t("1 modify three")
+        os.utime(self.pending, (0, 0))
+
+        code, out, err = self.t("list")
+        self.assertRegexpMatches(out, "1\s+three")
+        self.assertTrue(os.path.exists(self.journal))
+
+        self.t("2 modify four")
+        code, out, err = self.t("list")
+        self.assertRegexpMatches(out, "1\s+three")
+        self.assertRegexpMatches(out, "2\s+four")
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
+
+# vim: ai sts=4 et sw=4 ft=python
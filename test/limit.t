@@ -99,6 +99,21 @@ class TestLimit(TestCase):
         code, out, err = self.t("ls limit:page")
         self.assertIn("30 tasks, truncated to 22 lines", out)
 
+    def test_limit_sort_order(self):
+        """Verify limit:N shows the same leading tasks as a full sort"""
+        self.t("add one priority:L")
+        self.t("add two priority:H")
+        self.t("add three")
+        self.t("add four priority:H")
+        self.t("add five priority:M")
+
+        code, out, err = self.t("rc.report.foo.columns:id rc.report.foo.sort:priority-,id+ foo rc.verbose:nothing")
+        full = out.split()
+
+        code, out, err = self.t("rc.report.foo.columns:id rc.report.foo.sort:priority-,id+ foo rc.verbose:nothing limit:3")
+        self.assertEqual(out.split(), full[:3])
+        self.assertEqual(full[:3], ["2", "4", "5"])
+
 
 if __name__ == "__main__":
     from simpletap import TAPTestRunner
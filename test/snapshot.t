@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+###############################################################################
+#
+# Copyright 2006 - 2019, Paul Beckingham, Federico Hernandez.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included
+# in all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+# OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+# https://www.opensource.org/licenses/mit-license.php
+#
+###############################################################################
+
+import sys
+import os
+import unittest
+# Ensure python finds the local simpletap module
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+
+from basetest import Task, TestCase
+
+
+class TestSnapshot(TestCase):
+    def setUp(self):
+        self.t = Task()
+        self.t("add one")
+        self.t("add two")
+        self.pending = os.path.join(self.t.datadir, "pending.data")
+        self.snapshot = self.pending + ".snapshot"
+
+    def test_snapshot_created(self):
+        """Snapshot is written when pending.data is loaded"""
+        self.t("list")
+        self.assertTrue(os.path.exists(self.snapshot))
+
+        code, out, err = self.t("list")
+        self.assertIn("one", out)
+        self.assertIn("two", out)
+
+    def test_snapshot_mode(self):
+        """Snapshot has the permissions of pending.data"""
+        os.chmod(self.pending, 0o640)
+        if os.path.exists(self.snapshot):
+            os.remove(self.snapshot)
+
+        self.t("list")
+        self.assertEqual(os.stat(self.snapshot).st_mode & 0o777, 0o640)
+
+    def test_snapshot_off(self):
+        """No snapshot is written with rc.snapshot=0"""
+        self.t("list rc.snapshot=0")
+        self.assertFalse(os.path.exists(self.snapshot))
+
+    def test_snapshot_stale(self):
+        """External changes to pending.data invalidate the snapshot"""
+        self.t("list")
+        self.assertTrue(os.path.exists(self.snapshot))
+
+        with open(self.pending) as fh:
+            data = fh.read()
+        with open(self.pending, "w") as fh:
+            fh.write(data.replace("description:\"two\"",
+                                  "description:\"three\""))
+
+        code, out, err = self.t("list")
+        self.assertIn("three", out)
+        self.assertNotIn("two", out)
+
+    def test_snapshot_corrupt(self):
+        """A corrupt snapshot is ignored"""
+        self.t("list")
+        with open(self.snapshot, "wb") as fh:
+            fh.write(b"garbage")
+
+        code, out, err = self.t("list")
+        self.assertIn("one", out)
+        self.assertIn("two", out)
+
+
+if __name__ == "__main__":
+    from simpletap import TAPTestRunner
+    unittest.main(testRunner=TAPTestRunner())
+
+# vim: ai sts=4 et sw=4 ft=python
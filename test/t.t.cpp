@@ -32,7 +32,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest test (49);
+  UnitTest test (62);
 
   // Ensure environment has no influence.
   unsetenv ("TASKDATA");
@@ -213,6 +213,45 @@ TODO Task::decode
   // Task::all
   test.is (task.data.size (), (size_t)1, "Task::all size");
 
+  // Attributes are kept in name order, whatever the order of insertion.
+  Task sorted;
+  sorted.set ("zulu", "z");
+  sorted.set ("alpha", "a");
+  sorted.set ("mike", "m");
+  test.is (sorted.composeF4 (), "[alpha:\"a\" mike:\"m\" zulu:\"z\"]", "AttributeMap sorted by name");
+
+  Task same;
+  same.set ("mike", "m");
+  same.set ("zulu", "z");
+  same.set ("alpha", "a");
+  test.ok (sorted.data == same.data, "AttributeMap equal, regardless of insertion order");
+  same.set ("mike", "M");
+  test.ok (sorted.data != same.data, "AttributeMap not equal, after a value change");
+
+  // Iterators erase in place, and see values through 'first' and 'second'.
+  for (auto i = sorted.data.begin (); i != sorted.data.end (); )
+    if (i->first == "mike")
+      i = sorted.data.erase (i);
+    else
+      ++i;
+  test.is (sorted.composeF4 (), "[alpha:\"a\" zulu:\"z\"]", "AttributeMap::erase");
+
+  // The insert of an existing attribute leaves it unchanged.
+  test.notok (sorted.data.insert ({"alpha", "b"}), "AttributeMap::insert existing");
+  test.is (sorted.get ("alpha"), "a", "AttributeMap::insert existing, unchanged");
+
+  // Cached tags, status and dates follow every change to the data.
+  Task cache;
+  cache.addTag ("one");
+  test.is (cache.getTagCount (), 1, "Task::getTagCount after addTag");
+  cache.data["tags"] = "one,two";
+  test.ok (cache.hasTag ("two"), "Task::hasTag after a direct change to data");
+  test.ok (cache.getStatus () == Task::pending, "Task::getStatus defaults to pending");
+  cache.setStatus (Task::completed);
+  test.ok (cache.getStatus () == Task::completed, "Task::getStatus after setStatus");
+  cache.set ("due", "1234567890");
+  test.is ((int) cache.get_date ("due"), 1234567890, "Task::get_date after set");
+
   ////////////////////////////////////////////////////////////////////////////////
 
   Task::attributes["description"] = "string";
@@ -250,6 +289,16 @@ TODO Task::decode
   test.is (t7.composeF4 (), "[description:\"DESC\" entry:\"1370212800\" tags:\"tag1,tag2\"]", "F4 good");
   test.is (t7.composeJSON (), "{\"description\":\"DESC\",\"entry\":\"20130602T224000Z\",\"tags\":[\"tag1\",\"tag2\"]}", "JSON good");
 
+  // Task::parseF4 parses only FF4, and throws rather than falling back.
+  Task t8;
+  t8.parseF4 ("[description:\"DESC\" entry:\"1370212800\" tags:\"tag1,tag2\"]");
+  test.is (t8.composeF4 (), "[description:\"DESC\" entry:\"1370212800\" tags:\"tag1,tag2\"]", "Task::parseF4 round trip");
+
+  good = false;
+  try {Task t9; t9.parseF4 ("[]");}
+  catch (const std::string&) {good = true;}
+  test.ok (good, "Task::parseF4 ('[]') throws");
+
   return 0;
 }
 
@@ -36,7 +36,7 @@ Context context;
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (12);
+  UnitTest t (18);
 
   // Ensure environment has no influence.
   unsetenv ("TASKDATA");
@@ -50,6 +50,9 @@ int main (int, char**)
     unlink ("./completed.data");
     unlink ("./undo.data");
     unlink ("./backlog.data");
+    unlink ("./pending.data.snapshot");
+    unlink ("./completed.data.snapshot");
+    unlink ("./completed.data.index");
 
     // Set the context to allow GC.
     context.config.set ("gc", 1);
@@ -95,6 +98,16 @@ int main (int, char**)
     t.is ((int) undo.size (),      7, "TDB2 after add, 7 undo lines");
     t.is ((int) backlog.size (),   2, "TDB2 after add, 2 backlog task");
 
+    // Look up by UUID.
+    std::string uuid = task.get ("uuid");
+    Task found;
+    t.ok (context.tdb2.get (uuid, found),                    "TDB2 get by UUID");
+    t.is (found.get ("description"), "This is a test",       "TDB2 get by UUID, modified task");
+    t.ok (context.tdb2.get (uuid.substr (0, 8), found),      "TDB2 get by partial UUID");
+    t.ok (context.tdb2.has (uuid),                           "TDB2 has UUID");
+    t.notok (context.tdb2.has (uuid.substr (0, 8)),          "TDB2 has no partial UUID");
+    t.notok (context.tdb2.get ("00000000-0000-0000-0000-000000000000", found), "TDB2 get unknown UUID");
+
     context.tdb2.commit ();
 
     // Reset for reuse.
@@ -123,6 +136,9 @@ int main (int, char**)
   unlink ("./completed.data");
   unlink ("./undo.data");
   unlink ("./backlog.data");
+  unlink ("./pending.data.snapshot");
+  unlink ("./completed.data.snapshot");
+  unlink ("./completed.data.index");
 
   return 0;
 }
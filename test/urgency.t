@@ -54,6 +54,7 @@ class TestUrgency(TestCase):
         cls.t.config("urgency.user.tag.next.coefficient",        "10")
         cls.t.config("urgency.user.project.PROJECT.coefficient", "10")
         cls.t.config("urgency.user.tag.TAG.coefficient",         "10")
+        cls.t.config("urgency.user.keyword.urgent.coefficient",  "10")
         cls.t.config("confirmation",                             "0")
 
         cls.t("add control")                     # 1
@@ -129,6 +130,8 @@ class TestUrgency(TestCase):
 
         cls.t("add 13 pri:H")                    # 47
 
+        cls.t("add 14 urgent")                   # 48
+
     def assertApproximately(self, target, value):
         """Verify that the number in 'value' is within the range"""
         num = float(value.strip())
@@ -255,6 +258,11 @@ class TestUrgency(TestCase):
         code, out, err = self.t("_get 44.urgency")
         self.assertIn("18\n", out)
 
+    def test_urgency_user_keyword(self):
+        """Verify urgency calculations involving user keyword"""
+        code, out, err = self.t("_get 48.urgency")
+        self.assertIn("10\n", out)
+
     def test_urgency_scheduled(self):
         """Verify urgency calculations involving a scheduled task"""
         code, out, err = self.t("_get 45.urgency")
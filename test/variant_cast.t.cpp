@@ -34,7 +34,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (81);
+  UnitTest t (86);
 
   try
   {
@@ -241,6 +241,19 @@ int main (int, char**)
     v55.cast (Variant::type_duration);
     t.ok (v55.type () == Variant::type_duration, "cast duration --> duration");
     t.ok (v55.get_duration () == 12345,          "cast duration --> duration");
+
+    // Only the value of the current type is available.
+    Variant v56 (42);
+    t.ok (v56.get_date () == 0,                  "integer --> no date");
+    t.ok (v56.get_bool () == false,              "integer --> no boolean");
+
+    // Moving keeps the value and the source.
+    Variant v57 ("a long string, which does not fit in place");
+    v57.source ("description");
+    Variant v58 (std::move (v57));
+    t.is (v58.get_string (), "a long string, which does not fit in place", "move string --> string");
+    t.is (v58.source (), "description",          "move string --> source");
+    t.ok (v58.type () == Variant::type_string,   "move string --> type");
   }
 
   catch (const std::string& e)
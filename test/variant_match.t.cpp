@@ -35,7 +35,7 @@ Task task;
 ////////////////////////////////////////////////////////////////////////////////
 int main (int, char**)
 {
-  UnitTest t (120);
+  UnitTest t (127);
 
   Variant vs0 ("untrue");         // ~ true
   Variant vs1 (8421);             // ~ 42
@@ -291,6 +291,25 @@ int main (int, char**)
   t.is (v55.type (), Variant::type_boolean, "1200 ~ 1200 --> boolean");
   t.is (v55.get_bool (), true,              "1200 ~ 1200 --> true");
 
+  // Prepared patterns, literal and regex, with and without case.
+  Variant p0 ("FOO");
+  Variant p1 ("^fo+l");
+  Variant p2 ("^foo");
+  Variant p3 ("ish$");
+
+  Variant::searchCaseSensitive = false;
+  t.ok    (vs3.operator_match (p0.matcher (), task), "foolish ~ FOO (prepared, caseless) --> true");
+  Variant::searchCaseSensitive = true;
+  t.notok (vs3.operator_match (p0.matcher (), task), "foolish ~ FOO (prepared) --> false");
+  t.ok    (vs3.operator_match (p1.matcher (), task), "foolish ~ ^fo+l (prepared) --> true");
+  t.ok    (vs3.operator_nomatch (p0.matcher (), task), "foolish !~ FOO (prepared) --> true");
+
+  Variant::searchUsingRegex = false;
+  t.notok (vs3.operator_match (p1.matcher (), task), "foolish ~ ^fo+l (prepared, no regex) --> false");
+  t.ok    (vs3.operator_match (p2.matcher (), task), "foolish ~ ^foo (prepared, no regex) --> true");
+  t.ok    (vs3.operator_match (p3.matcher (), task), "foolish ~ ish$ (prepared, no regex) --> true");
+  Variant::searchUsingRegex = true;
+
   return 0;
 }
 